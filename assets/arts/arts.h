@@ -0,0 +1,65 @@
+#pragma once
+
+static const struct art_cell art_kakehi_ki_cells[] = {
+    { 0x2501, { .color = color_blue } }, { 0x2550, { .color = color_yellow } }, { 0x2550, { .color = color_yellow } },
+};
+static const struct art art_kakehi_ki = { .size = { .x = 3, .y = 1 }, .cells = art_kakehi_ki_cells };
+
+static const struct art_cell art_kakehi_sho_cells[] = {
+    { 0x2550, { .color = color_yellow } }, { 0x2501, { .color = color_blue } }, { 0x2550, { .color = color_yellow } },
+};
+static const struct art art_kakehi_sho = { .size = { .x = 3, .y = 1 }, .cells = art_kakehi_sho_cells };
+
+static const struct art_cell art_kakehi_ten_cells[] = {
+    { 0x2550, { .color = color_yellow } }, { 0x2550, { .color = color_yellow } }, { 0x2501, { .color = color_blue } },
+};
+static const struct art art_kakehi_ten = { .size = { .x = 3, .y = 1 }, .cells = art_kakehi_ten_cells };
+
+static const struct art_cell art_kakehi_ketsu_cells[] = {
+    { 0x2550, { .color = color_yellow } }, { 0x2550, { .color = color_yellow } }, { 0x2550, { .color = color_yellow } },
+};
+static const struct art art_kakehi_ketsu = { .size = { .x = 3, .y = 1 }, .cells = art_kakehi_ketsu_cells };
+
+static const struct art_cell art_tsutsu_jo_cells[] = {
+    { 0x25e5, { .color = color_green } }, { 0x25e3, { .color = color_green } }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x25e5, { .color = color_green } }, { 0x25e3, { .color = color_green } }, { 0 }, { 0 }, { 0 }, { 0 },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x2595, { .color = color_yellow } }, { 0x0020, { .color = color_white } }, { 0x25e5, { .color = color_green } }, { 0x25e3, { .color = color_green } }, { 0 }, { 0 },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x2595, { .color = color_yellow } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x25e5, { .color = color_green } }, { 0x25e3, { .color = color_green } },
+};
+static const struct art art_tsutsu_jo = { .size = { .x = 8, .y = 4 }, .cells = art_tsutsu_jo_cells };
+
+static const struct art_cell art_tsutsu_ha_cells[] = {
+    { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 },
+    { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x2595, { .color = color_yellow } }, { 0x0020, { .color = color_white } }, { 0 }, { 0 }, { 0 }, { 0 },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x2595, { .color = color_yellow } }, { 0x0020, { .color = color_white } }, { 0 }, { 0 }, { 0 }, { 0 },
+};
+static const struct art art_tsutsu_ha = { .size = { .x = 8, .y = 4 }, .cells = art_tsutsu_ha_cells };
+
+static const struct art_cell art_tsutsu_kyu_cells[] = {
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0 }, { 0 },
+    { 0x0020, { .color = color_white } }, { 0x0020, { .color = color_white } }, { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0 }, { 0 }, { 0 }, { 0 },
+    { 0x25e2, { .color = color_green } }, { 0x25e4, { .color = color_green } }, { 0x2595, { .color = color_yellow } }, { 0 }, { 0 }, { 0 }, { 0 }, { 0 },
+};
+static const struct art art_tsutsu_kyu = { .size = { .x = 8, .y = 4 }, .cells = art_tsutsu_kyu_cells };
+
+static const struct art_cell art_hachi_jo_cells[] = {
+    { 0x25ad, { .color = color_grey } }, { 0x25ad, { .color = color_grey } }, { 0x25ad, { .color = color_grey } }, { 0x25ad, { .color = color_grey } },
+};
+static const struct art art_hachi_jo = { .size = { .x = 4, .y = 1 }, .cells = art_hachi_jo_cells };
+
+static const struct art_cell art_hachi_ha_cells[] = {
+    { 0x25ad, { .color = color_grey } }, { 0x25ac, { .color = color_blue } }, { 0x25ac, { .color = color_blue } }, { 0x25ad, { .color = color_grey } },
+};
+static const struct art art_hachi_ha = { .size = { .x = 4, .y = 1 }, .cells = art_hachi_ha_cells };
+
+static const struct art_cell art_hachi_kyu_cells[] = {
+    { 0x25ac, { .color = color_blue } }, { 0x25ad, { .color = color_grey } }, { 0x25ad, { .color = color_grey } }, { 0x25ac, { .color = color_blue } },
+};
+static const struct art art_hachi_kyu = { .size = { .x = 4, .y = 1 }, .cells = art_hachi_kyu_cells };
+
+static const struct art_cell art_roji_cells[] = {
+    { 0x2501, { .color = color_green, .dim = true } }, { 0x2501, { .color = color_green, .dim = true } }, { 0x2501, { .color = color_green, .dim = true } }, { 0x2501, { .color = color_green, .dim = true } }, { 0x2501, { .color = color_green, .dim = true } }, { 0x2501, { .color = color_green, .dim = true } }, { 0x25a8, { .color = color_grey } }, { 0x25a8, { .color = color_grey } }, { 0x25a8, { .color = color_grey } }, { 0x25a8, { .color = color_grey } },
+};
+static const struct art art_roji = { .size = { .x = 10, .y = 1 }, .cells = art_roji_cells };
@@ -0,0 +1,19 @@
+#include "bench.h"
+#include <stdio.h>
+
+int main(void)
+{
+    printf("# canvas\n");
+    bench_canvas();
+    printf("\n");
+
+    printf("# platform\n");
+    bench_platform();
+    printf("\n");
+
+    printf("# mode\n");
+    bench_mode();
+    printf("\n");
+
+    return EXIT_SUCCESS;
+}
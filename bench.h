@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdlib.h>
+
+extern void bench_canvas(void);
+extern void bench_mode(void);
+extern void bench_platform(void);
@@ -1,31 +1,60 @@
+// Enable the wide-character API of curses (cchar_t and friends).
+#define _XOPEN_SOURCE_EXTENDED
+
 #include "canvas.h"
 
 #include "math.h"
-#include "memory.h"
 #include "string.h"
+#include <assert.h>
 #include <curses.h>
 #include <locale.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 static void deinit_canvas_buffer(struct canvas_buffer* canvas);
 static void deinit_canvas_curses(struct canvas_curses* canvas);
+static void deinit_canvas_ansi(struct canvas_ansi* canvas);
+
+static void fit_canvas_curses(struct canvas_curses* canvas);
+static void fit_canvas_ansi(struct canvas_ansi* canvas);
+static void fit_canvas_proxy(struct canvas_proxy* canvas);
 
 static void clear_canvas_buffer(struct canvas_buffer* canvas);
 static void clear_canvas_curses(struct canvas_curses* canvas);
+static void clear_canvas_ansi(struct canvas_ansi* canvas);
 
+static void flush_canvas_buffer(struct canvas_buffer* canvas);
 static void flush_canvas_curses(struct canvas_curses* canvas);
+static void flush_canvas_ansi(struct canvas_ansi* canvas);
 static void flush_canvas_proxy(struct canvas_proxy* canvas);
 
 static void draw_buffer(struct canvas_buffer* canvas, struct vec2d point, struct drawing_attr attr, const char* s);
 static void draw_curses(struct canvas_curses* canvas, struct vec2d point, struct drawing_attr attr, const char* s);
+static void draw_ansi(struct canvas_ansi* canvas, struct vec2d point, struct drawing_attr attr, const char* s);
+
+static void draw_codes_buffer(struct canvas_buffer* canvas, struct vec2d point, struct drawing_attr attr, const uint32_t* codes, unsigned int len);
+static void draw_codes_curses(struct canvas_curses* canvas, struct vec2d point, struct drawing_attr attr, const uint32_t* codes, unsigned int len);
+static void draw_codes_ansi(struct canvas_ansi* canvas, struct vec2d point, struct drawing_attr attr, const uint32_t* codes, unsigned int len);
+
+static void draw_data(struct canvas* canvas, struct vec2d point, const struct canvas_datum* data, unsigned int len);
+static void draw_data_buffer(struct canvas_buffer* canvas, struct vec2d point, const struct canvas_datum* data, unsigned int len);
+static void draw_data_curses(struct canvas_curses* canvas, struct vec2d point, const struct canvas_datum* data, unsigned int len);
+static void draw_data_ansi(struct canvas_ansi* canvas, struct vec2d point, const struct canvas_datum* data, unsigned int len);
 
 static void drawfv_buffer(struct canvas_buffer* canvas, struct vec2d point, struct drawing_attr attr, const char* format, va_list args);
 static void drawfv_curses(struct canvas_curses* canvas, struct vec2d point, struct drawing_attr attr, const char* format, va_list args);
+static void drawfv_ansi(struct canvas_ansi* canvas, struct vec2d point, struct drawing_attr attr, const char* format, va_list args);
 
 static struct vec2d get_canvas_size_curses(const struct canvas_curses* canvas);
+static bool get_terminal_size(int fd, struct vec2d* size);
 
 static struct canvas_buffer* serve_current_canvas_buffer(struct canvas_proxy* canvas);
+static struct canvas_buffer* serve_prev_canvas_buffer(struct canvas_proxy* canvas);
 
 struct canvas wrap_canvas_buffer(struct canvas_buffer* const canvas)
 {
@@ -43,6 +72,14 @@ struct canvas wrap_canvas_curses(struct canvas_curses* const canvas)
     };
 }
 
+struct canvas wrap_canvas_ansi(struct canvas_ansi* const canvas)
+{
+    return (struct canvas) {
+        .type = canvas_ansi,
+        .delegate = { .ansi = canvas },
+    };
+}
+
 struct canvas wrap_canvas_proxy(struct canvas_proxy* const canvas)
 {
     return (struct canvas) {
@@ -63,22 +100,40 @@ void deinit_canvas(struct canvas* const canvas)
     case canvas_curses:
         deinit_canvas_curses(delegate->curses);
         break;
+    case canvas_ansi:
+        deinit_canvas_ansi(delegate->ansi);
+        break;
     case canvas_proxy: {
-        {
-            struct canvas canvas = wrap_canvas_buffer(
-                serve_current_canvas_buffer(delegate->proxy)
-            );
-            deinit_canvas(&canvas);
-        }
-        {
-            struct canvas canvas = wrap_canvas_curses(delegate->proxy->underlying);
+        for (int i = 0; i < CANVAS_PROXY_BUFFER_BUCKET_SIZE; i++) {
+            struct canvas canvas = wrap_canvas_buffer(&delegate->proxy->buffers[i]);
             deinit_canvas(&canvas);
         }
+        deinit_canvas(&delegate->proxy->underlying);
         break;
     }
     }
 }
 
+// NOLINTNEXTLINE(misc-no-recursion)
+void fit_canvas(struct canvas* const canvas)
+{
+    union canvas_delegate* const delegate = &canvas->delegate;
+
+    switch (canvas->type) {
+    case canvas_buffer:
+        break;
+    case canvas_curses:
+        fit_canvas_curses(delegate->curses);
+        break;
+    case canvas_ansi:
+        fit_canvas_ansi(delegate->ansi);
+        break;
+    case canvas_proxy:
+        fit_canvas_proxy(delegate->proxy);
+        break;
+    }
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 void clear_canvas(struct canvas* const canvas)
 {
@@ -91,6 +146,9 @@ void clear_canvas(struct canvas* const canvas)
     case canvas_curses:
         clear_canvas_curses(delegate->curses);
         break;
+    case canvas_ansi:
+        clear_canvas_ansi(delegate->ansi);
+        break;
     case canvas_proxy: {
         struct canvas canvas = wrap_canvas_buffer(
             serve_current_canvas_buffer(delegate->proxy)
@@ -108,10 +166,14 @@ void flush_canvas(struct canvas* const canvas)
 
     switch (canvas->type) {
     case canvas_buffer:
+        flush_canvas_buffer(delegate->buffer);
         break;
     case canvas_curses:
         flush_canvas_curses(delegate->curses);
         break;
+    case canvas_ansi:
+        flush_canvas_ansi(delegate->ansi);
+        break;
     case canvas_proxy: {
         flush_canvas_proxy(delegate->proxy);
         break;
@@ -131,6 +193,9 @@ void draw(struct canvas* const canvas, const struct vec2d point, const struct dr
     case canvas_curses:
         draw_curses(delegate->curses, point, attr, s);
         break;
+    case canvas_ansi:
+        draw_ansi(delegate->ansi, point, attr, s);
+        break;
     case canvas_proxy: {
         struct canvas canvas = wrap_canvas_buffer(
             serve_current_canvas_buffer(delegate->proxy)
@@ -141,6 +206,36 @@ void draw(struct canvas* const canvas, const struct vec2d point, const struct dr
     }
 }
 
+void draw_cell(struct canvas* const canvas, const struct vec2d point, const struct drawing_attr attr, const uint32_t code)
+{
+    draw_codes(canvas, point, attr, &code, 1);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void draw_codes(struct canvas* const canvas, const struct vec2d point, const struct drawing_attr attr, const uint32_t* const codes, const unsigned int len)
+{
+    union canvas_delegate* const delegate = &canvas->delegate;
+
+    switch (canvas->type) {
+    case canvas_buffer:
+        draw_codes_buffer(delegate->buffer, point, attr, codes, len);
+        break;
+    case canvas_curses:
+        draw_codes_curses(delegate->curses, point, attr, codes, len);
+        break;
+    case canvas_ansi:
+        draw_codes_ansi(delegate->ansi, point, attr, codes, len);
+        break;
+    case canvas_proxy: {
+        struct canvas canvas = wrap_canvas_buffer(
+            serve_current_canvas_buffer(delegate->proxy)
+        );
+        draw_codes(&canvas, point, attr, codes, len);
+        break;
+    }
+    }
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 void drawfv(struct canvas* const canvas, const struct vec2d point, const struct drawing_attr attr, const char* const format, va_list args)
 {
@@ -153,6 +248,9 @@ void drawfv(struct canvas* const canvas, const struct vec2d point, const struct
     case canvas_curses:
         drawfv_curses(delegate->curses, point, attr, format, args);
         break;
+    case canvas_ansi:
+        drawfv_ansi(delegate->ansi, point, attr, format, args);
+        break;
     case canvas_proxy: {
         struct canvas canvas = wrap_canvas_buffer(
             serve_current_canvas_buffer(delegate->proxy)
@@ -173,7 +271,25 @@ void drawf(struct canvas* const canvas, const struct vec2d point, const struct d
     va_end(args);
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
+// blit copies the sprite drawn in advance onto the canvas row by row.
+// Only the drawn span of each row is copied, so that the blank margins of the sprite are transparent.
+void blit(struct canvas* const canvas, const struct vec2d point, const struct canvas_buffer* const sprite)
+{
+    for (unsigned int y = 0; y < sprite->size.y; y++) {
+        const struct canvas_row* const row = &sprite->rows[y];
+        if (row->epoch != sprite->epoch || row->dirty.begin >= row->dirty.end) {
+            continue;
+        }
+
+        draw_data(
+            canvas,
+            vec2d_add(point, (struct vec2d) { .x = row->dirty.begin, .y = y }),
+            &sprite->data[y * sprite->size.x + row->dirty.begin],
+            row->dirty.end - row->dirty.begin
+        );
+    }
+}
+
 struct vec2d get_canvas_size(const struct canvas* const canvas)
 {
     const union canvas_delegate* const delegate = &canvas->delegate;
@@ -183,59 +299,414 @@ struct vec2d get_canvas_size(const struct canvas* const canvas)
         return delegate->buffer->size;
     case canvas_curses:
         return get_canvas_size_curses(delegate->curses);
+    case canvas_ansi:
+        return delegate->ansi->size;
+    case canvas_proxy:
+        return get_canvas_size(&delegate->proxy->underlying);
+    }
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static void draw_data(struct canvas* const canvas, const struct vec2d point, const struct canvas_datum* const data, const unsigned int len)
+{
+    union canvas_delegate* const delegate = &canvas->delegate;
+
+    switch (canvas->type) {
+    case canvas_buffer:
+        draw_data_buffer(delegate->buffer, point, data, len);
+        break;
+    case canvas_curses:
+        draw_data_curses(delegate->curses, point, data, len);
+        break;
+    case canvas_ansi:
+        draw_data_ansi(delegate->ansi, point, data, len);
+        break;
     case canvas_proxy: {
-        struct canvas canvas = wrap_canvas_curses(delegate->proxy->underlying);
-        return get_canvas_size(&canvas);
+        struct canvas canvas = wrap_canvas_buffer(
+            serve_current_canvas_buffer(delegate->proxy)
+        );
+        draw_data(&canvas, point, data, len);
+        break;
+    }
     }
+}
+
+// datum
+
+enum {
+    // Glyphs below this are ASCII characters whose indices are their code points as they are.
+    glyph_ascii_len = 1 << 7,
+    glyph_palette_cap = 1 << 16,
+};
+
+// glyph_palette interns the code points drawn onto any canvas buffer, so that cells can hold their glyphs in 16 bits.
+// It is shared by all the buffers so that cells can be compared and copied across them as they are,
+// and released once the last of them is deinitialized.
+static struct {
+    uint32_t* codes;
+    size_t len;
+    size_t cap;
+
+    // table is an open-addressing hash table from code points to glyphs, where 0 is an empty slot.
+    uint16_t* table;
+    size_t table_cap;
+    // table_bits is the log2 of the table_cap.
+    unsigned int table_bits;
+
+    unsigned int buffers;
+} glyph_palette = { 0 };
+
+static uint16_t intern_glyph(uint32_t code);
+static bool rehash_glyph_palette(unsigned int bits);
+static size_t hash_glyph_code(uint32_t code, unsigned int bits);
+static void retain_glyph_palette(void);
+static void release_glyph_palette(void);
+
+static struct canvas_datum make_canvas_datum(const uint32_t code, const struct drawing_attr attr)
+{
+    return (struct canvas_datum) {
+        .glyph = intern_glyph(code),
+        .attr = (uint8_t)((attr.color & 0x7) | (attr.dim ? 1 << 3 : 0) | (attr.bold ? 1 << 4 : 0)),
+    };
+}
+
+static uint32_t get_canvas_datum_code(const struct canvas_datum* const datum)
+{
+    if (datum->glyph < glyph_ascii_len) {
+        return datum->glyph;
     }
+
+    return glyph_palette.codes[datum->glyph - glyph_ascii_len];
+}
+
+static struct drawing_attr get_canvas_datum_attr(const struct canvas_datum* const datum)
+{
+    return (struct drawing_attr) {
+        .color = (enum color)(datum->attr & 0x7),
+        .dim = (datum->attr & 1 << 3) != 0,
+        .bold = (datum->attr & 1 << 4) != 0,
+    };
+}
+
+static uint16_t intern_glyph(const uint32_t code)
+{
+    if (code < glyph_ascii_len) {
+        return (uint16_t)code;
+    }
+
+    if (glyph_palette.table != NULL) {
+        for (size_t i = hash_glyph_code(code, glyph_palette.table_bits);; i = (i + 1) % glyph_palette.table_cap) {
+            const uint16_t glyph = glyph_palette.table[i];
+            if (glyph == 0) {
+                break;
+            }
+            if (glyph_palette.codes[glyph - glyph_ascii_len] == code) {
+                return glyph;
+            }
+        }
+    }
+
+    if (glyph_ascii_len + glyph_palette.len >= glyph_palette_cap) {
+        return '?';
+    }
+
+    // Keep the table at most half full.
+    if ((glyph_palette.len + 1) * 2 > glyph_palette.table_cap) {
+        if (!rehash_glyph_palette(MAX(glyph_palette.table_bits + 1, 6))) {
+            return '?';
+        }
+    }
+
+    if (glyph_palette.len >= glyph_palette.cap) {
+        const size_t cap = MAX(glyph_palette.cap * 2, 1 << 5);
+        uint32_t* const codes = realloc(glyph_palette.codes, cap * sizeof(uint32_t));
+        if (codes == NULL) {
+            return '?';
+        }
+
+        glyph_palette.codes = codes;
+        glyph_palette.cap = cap;
+    }
+
+    const uint16_t glyph = (uint16_t)(glyph_ascii_len + glyph_palette.len);
+    glyph_palette.codes[glyph_palette.len] = code;
+    glyph_palette.len++;
+
+    size_t i = hash_glyph_code(code, glyph_palette.table_bits);
+    while (glyph_palette.table[i] != 0) {
+        i = (i + 1) % glyph_palette.table_cap;
+    }
+    glyph_palette.table[i] = glyph;
+
+    return glyph;
+}
+
+static bool rehash_glyph_palette(const unsigned int bits)
+{
+    const size_t cap = (size_t)1 << bits;
+
+    uint16_t* const table = calloc(cap, sizeof(uint16_t));
+    if (table == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < glyph_palette.len; i++) {
+        size_t j = hash_glyph_code(glyph_palette.codes[i], bits);
+        while (table[j] != 0) {
+            j = (j + 1) % cap;
+        }
+        table[j] = (uint16_t)(glyph_ascii_len + i);
+    }
+
+    free(glyph_palette.table);
+    glyph_palette.table = table;
+    glyph_palette.table_cap = cap;
+    glyph_palette.table_bits = bits;
+
+    return true;
+}
+
+// hash_glyph_code hashes the code into the table of 2^bits slots with Fibonacci hashing,
+// which takes the high bits of the product so that codes close to each other spread over the table.
+static size_t hash_glyph_code(const uint32_t code, const unsigned int bits)
+{
+    return (size_t)((uint32_t)(code * 2654435769u) >> (32 - bits));
+}
+
+static void retain_glyph_palette(void)
+{
+    glyph_palette.buffers++;
+}
+
+static void release_glyph_palette(void)
+{
+    if (glyph_palette.buffers == 0 || --glyph_palette.buffers != 0) {
+        return;
+    }
+
+    free(glyph_palette.codes);
+    glyph_palette.codes = NULL;
+    glyph_palette.len = 0;
+    glyph_palette.cap = 0;
+
+    free(glyph_palette.table);
+    glyph_palette.table = NULL;
+    glyph_palette.table_cap = 0;
+    glyph_palette.table_bits = 0;
 }
 
 // buffer
 
+static bool reserve_canvas_buffer(struct canvas_buffer* canvas, struct vec2d size);
+static void blank_canvas_buffer(struct canvas_buffer* canvas);
+static void settle_canvas_buffer(struct canvas_buffer* canvas);
+static void revive_row_buffer(struct canvas_buffer* canvas, unsigned int y);
+static void mark_dirty_buffer(struct canvas_buffer* canvas, unsigned int y, unsigned int begin, unsigned int end);
+static struct canvas_span join_canvas_spans(struct canvas_span span, struct canvas_span other);
+
 void init_canvas_buffer(struct canvas_buffer* const canvas, const struct vec2d size)
 {
     canvas->size = size;
-    canvas->data = calloc(
-        (long)size.x * size.y,
-        sizeof(struct canvas_datum)
-    );
+
+    canvas->capacity.data = (size_t)size.x * size.y;
+    canvas->data = malloc(canvas->capacity.data * sizeof(struct canvas_datum));
+
+    canvas->capacity.rows = size.y;
+    canvas->rows = malloc(canvas->capacity.rows * sizeof(struct canvas_row));
+
+    retain_glyph_palette();
+
+    blank_canvas_buffer(canvas);
 }
 
 static void deinit_canvas_buffer(struct canvas_buffer* const canvas)
 {
     free(canvas->data);
     canvas->data = NULL;
+    canvas->capacity.data = 0;
+
+    free(canvas->rows);
+    canvas->rows = NULL;
+    canvas->capacity.rows = 0;
 
     canvas->size.x = 0;
     canvas->size.y = 0;
+
+    release_glyph_palette();
+}
+
+// resize_canvas_buffer reuses the current allocations unless they are too small for the size.
+// The contents are blanked, or left as they are with the size if the allocations fail to grow.
+static bool resize_canvas_buffer(struct canvas_buffer* const canvas, const struct vec2d size)
+{
+    if (!reserve_canvas_buffer(canvas, size)) {
+        return false;
+    }
+
+    canvas->size = size;
+
+    blank_canvas_buffer(canvas);
+
+    return true;
+}
+
+// reserve_canvas_buffer grows the allocations enough for the size, without changing the size or the contents.
+static bool reserve_canvas_buffer(struct canvas_buffer* const canvas, const struct vec2d size)
+{
+    const size_t len = (size_t)size.x * size.y;
+
+    if (len > canvas->capacity.data) {
+        struct canvas_datum* const data = realloc(canvas->data, len * sizeof(struct canvas_datum));
+        if (data == NULL) {
+            return false;
+        }
+
+        canvas->data = data;
+        canvas->capacity.data = len;
+    }
+
+    if (size.y > canvas->capacity.rows) {
+        struct canvas_row* const rows = realloc(canvas->rows, size.y * sizeof(struct canvas_row));
+        if (rows == NULL) {
+            return false;
+        }
+
+        canvas->rows = rows;
+        canvas->capacity.rows = size.y;
+    }
+
+    return true;
 }
 
 static void clear_canvas_buffer(struct canvas_buffer* const canvas)
 {
-    for (unsigned int h = 0; h < canvas->size.y; h++) {
-        for (unsigned int w = 0; w < canvas->size.x; w++) {
-            canvas->data[h * canvas->size.x + w].code = ' ';
-            canvas->data[h * canvas->size.x + w].attr = (struct drawing_attr) { 0 };
+    // Clearing costs nothing but starting a new epoch, as rows drawn in past epochs read as blank.
+    canvas->epoch++;
+
+    if (canvas->epoch == 0) {
+        // Rewind the epochs of all the rows so that none of them is taken as live by chance after the wraparound.
+        for (unsigned int y = 0; y < canvas->size.y; y++) {
+            canvas->rows[y].epoch = 0;
+        }
+        canvas->epoch = 1;
+    }
+}
+
+static void flush_canvas_buffer(struct canvas_buffer* const canvas)
+{
+    settle_canvas_buffer(canvas);
+}
+
+static void blank_canvas_buffer(struct canvas_buffer* const canvas)
+{
+    canvas->epoch = 1;
+
+    for (unsigned int y = 0; y < canvas->size.y; y++) {
+        canvas->rows[y] = (struct canvas_row) {
+            .dirty = { .begin = 0, .end = canvas->size.x },
+        };
+    }
+
+    settle_canvas_buffer(canvas);
+}
+
+// settle_canvas_buffer blanks the rows which were drawn in past epochs but not in the current one,
+// so that the data can be read as it is.
+static void settle_canvas_buffer(struct canvas_buffer* const canvas)
+{
+    for (unsigned int y = 0; y < canvas->size.y; y++) {
+        const struct canvas_row* const row = &canvas->rows[y];
+        if (row->epoch == canvas->epoch || row->dirty.begin >= row->dirty.end) {
+            continue;
         }
+
+        revive_row_buffer(canvas, y);
     }
 }
 
+static void revive_row_buffer(struct canvas_buffer* const canvas, const unsigned int y)
+{
+    struct canvas_row* const row = &canvas->rows[y];
+    if (row->epoch == canvas->epoch) {
+        return;
+    }
+
+    // Only the dirty span can hold anything other than blanks.
+    struct canvas_datum* const data = &canvas->data[y * canvas->size.x];
+    for (unsigned int x = row->dirty.begin; x < row->dirty.end; x++) {
+        data[x] = (struct canvas_datum) { .glyph = ' ' };
+    }
+
+    *row = (struct canvas_row) { .epoch = canvas->epoch };
+}
+
+static void mark_dirty_buffer(struct canvas_buffer* const canvas, const unsigned int y, const unsigned int begin, const unsigned int end)
+{
+    struct canvas_row* const row = &canvas->rows[y];
+    row->dirty = join_canvas_spans(row->dirty, (struct canvas_span) { .begin = begin, .end = end });
+}
+
 static void draw_buffer(struct canvas_buffer* const canvas, const struct vec2d point, const struct drawing_attr attr, const char* const s)
 {
+    if (point.y >= canvas->size.y) {
+        return;
+    }
+
+    revive_row_buffer(canvas, point.y);
+
     unsigned int n = 0;
     const char* c = s;
 
-    while (*c) {
+    while (*c && point.x + n < canvas->size.x) {
         const struct char_descriptor desc = decode_char_utf8(c);
 
         const unsigned int i = point.y * canvas->size.x + point.x + n;
-        struct canvas_datum* const datum = &canvas->data[i];
-        datum->code = desc.code;
-        datum->attr = attr;
+        canvas->data[i] = make_canvas_datum(desc.code, attr);
 
         n++;
         c += desc.len;
     }
+
+    mark_dirty_buffer(canvas, point.y, point.x, point.x + n);
+}
+
+static void draw_codes_buffer(
+    struct canvas_buffer* const canvas,
+    const struct vec2d point,
+    const struct drawing_attr attr,
+    const uint32_t* const codes, const unsigned int len
+)
+{
+    if (point.y >= canvas->size.y || point.x >= canvas->size.x) {
+        return;
+    }
+
+    revive_row_buffer(canvas, point.y);
+
+    const unsigned int n = MIN(len, canvas->size.x - point.x);
+
+    struct canvas_datum* const data = &canvas->data[point.y * canvas->size.x + point.x];
+    for (unsigned int i = 0; i < n; i++) {
+        data[i] = make_canvas_datum(codes[i], attr);
+    }
+
+    mark_dirty_buffer(canvas, point.y, point.x, point.x + n);
+}
+
+static void draw_data_buffer(struct canvas_buffer* const canvas, const struct vec2d point, const struct canvas_datum* const data, const unsigned int len)
+{
+    if (point.y >= canvas->size.y || point.x >= canvas->size.x) {
+        return;
+    }
+
+    revive_row_buffer(canvas, point.y);
+
+    const unsigned int n = MIN(len, canvas->size.x - point.x);
+
+    const unsigned int i = point.y * canvas->size.x + point.x;
+    memcpy(&canvas->data[i], data, n * sizeof(struct canvas_datum));
+
+    mark_dirty_buffer(canvas, point.y, point.x, point.x + n);
 }
 
 static void drawfv_buffer(
@@ -250,23 +721,79 @@ static void drawfv_buffer(
     draw_buffer(canvas, point, attr, s);
 }
 
-static unsigned int canvas_data_size_buffer(const struct canvas_buffer* const canvas)
+static bool canvas_datum_equals(const struct canvas_datum* const datum, const struct canvas_datum* const other)
 {
-    return (unsigned long)canvas->size.x * canvas->size.y * sizeof(struct canvas_datum);
+    return datum->glyph == other->glyph && datum->attr == other->attr;
 }
 
-static bool canvas_equals_buffer(const struct canvas_buffer* const canvas, const struct canvas_buffer* const other)
+uint32_t get_canvas_buffer_code(const struct canvas_buffer* const canvas, const struct vec2d point)
 {
-    return mem_equals_n(
-        canvas->data, other->data,
-        canvas_data_size_buffer(canvas)
-    );
+    return get_canvas_datum_code(&canvas->data[point.y * canvas->size.x + point.x]);
+}
+
+static struct canvas_span join_canvas_spans(const struct canvas_span span, const struct canvas_span other)
+{
+    if (span.begin >= span.end) {
+        return other;
+    }
+    if (other.begin >= other.end) {
+        return span;
+    }
+
+    return (struct canvas_span) {
+        .begin = MIN(span.begin, other.begin),
+        .end = MAX(span.end, other.end),
+    };
+}
+
+bool find_canvas_diff_run(
+    const struct canvas_buffer* const canvas, const struct canvas_buffer* const other,
+    const struct vec2d from, struct canvas_diff_run* const run
+)
+{
+    assert(canvas->size.x == other->size.x && canvas->size.y == other->size.y);
+
+    unsigned int x = from.x;
+
+    for (unsigned int y = from.y; y < canvas->size.y; y++, x = 0) {
+        // Cells out of the dirty spans of both the buffers are blank in both of them.
+        const struct canvas_span span = join_canvas_spans(canvas->rows[y].dirty, other->rows[y].dirty);
+        const unsigned int end = MIN(span.end, canvas->size.x);
+
+        x = MAX(x, span.begin);
+
+        const struct canvas_datum* const row = &canvas->data[y * canvas->size.x];
+        const struct canvas_datum* const other_row = &other->data[y * canvas->size.x];
+
+        while (x < end && canvas_datum_equals(&row[x], &other_row[x])) {
+            x++;
+        }
+        if (x >= end) {
+            continue;
+        }
+
+        unsigned int len = 1;
+        while (x + len < end && !canvas_datum_equals(&row[x + len], &other_row[x + len])) {
+            len++;
+        }
+
+        *run = (struct canvas_diff_run) {
+            .point = { .x = x, .y = y },
+            .len = len,
+        };
+
+        return true;
+    }
+
+    return false;
 }
 
 // curses
 
 static void register_color_curses(enum color color, short r, short g, short b, short supplement);
 static short as_color_curses(enum color color);
+static void set_curses_cell(cchar_t* cell, uint32_t code, struct drawing_attr attr);
+static void draw_cells_curses(struct canvas_curses* canvas, struct vec2d point, const cchar_t* cells, unsigned int len);
 
 void init_canvas_curses(struct canvas_curses* const canvas)
 {
@@ -294,6 +821,19 @@ void init_canvas_curses(struct canvas_curses* const canvas)
     }
 }
 
+static void fit_canvas_curses(struct canvas_curses* const canvas)
+{
+    struct vec2d size = { 0 };
+    if (!get_terminal_size(STDOUT_FILENO, &size)) {
+        return;
+    }
+
+    resizeterm((int)size.y, (int)size.x);
+
+    // Repaint the whole screen on the next refresh as the terminal may have reflowed what it showed.
+    clearok(canvas->window, TRUE);
+}
+
 static void deinit_canvas_curses(struct canvas_curses* const canvas)
 {
     endwin();
@@ -337,6 +877,63 @@ static void draw_curses(struct canvas_curses* const canvas, const struct vec2d p
     });
 }
 
+static void draw_codes_curses(
+    struct canvas_curses* const canvas,
+    const struct vec2d point,
+    const struct drawing_attr attr,
+    const uint32_t* const codes, const unsigned int len
+)
+{
+    for (unsigned int i = 0; i < len;) {
+        const unsigned int n = MIN(len - i, CANVAS_CURSES_CHUNK_LEN);
+
+        cchar_t cells[CANVAS_CURSES_CHUNK_LEN];
+        for (unsigned int j = 0; j < n; j++) {
+            set_curses_cell(&cells[j], codes[i + j], attr);
+        }
+
+        draw_cells_curses(canvas, (struct vec2d) { .x = point.x + i, .y = point.y }, cells, n);
+
+        i += n;
+    }
+}
+
+// draw_data_curses writes the run of data a chunk of cells per call without formatting or attribute toggling,
+// as each cchar_t carries its own attribute.
+static void draw_data_curses(struct canvas_curses* const canvas, const struct vec2d point, const struct canvas_datum* const data, const unsigned int len)
+{
+    for (unsigned int i = 0; i < len;) {
+        const unsigned int n = MIN(len - i, CANVAS_CURSES_CHUNK_LEN);
+
+        cchar_t cells[CANVAS_CURSES_CHUNK_LEN];
+        for (unsigned int j = 0; j < n; j++) {
+            const struct canvas_datum* const datum = &data[i + j];
+            set_curses_cell(&cells[j], get_canvas_datum_code(datum), get_canvas_datum_attr(datum));
+        }
+
+        draw_cells_curses(canvas, (struct vec2d) { .x = point.x + i, .y = point.y }, cells, n);
+
+        i += n;
+    }
+}
+
+static void set_curses_cell(cchar_t* const cell, const uint32_t code, const struct drawing_attr attr)
+{
+    const wchar_t codes[] = { (wchar_t)code, 0 };
+
+    attr_t flags = 0;
+    flags |= attr.dim ? WA_DIM : 0;
+    flags |= attr.bold ? WA_BOLD : 0;
+
+    setcchar(cell, codes, flags, (short)attr.color, NULL);
+}
+
+// draw_cells_curses writes the cells of at most a chunk in a single call.
+static void draw_cells_curses(struct canvas_curses* const canvas, const struct vec2d point, const cchar_t* const cells, const unsigned int len)
+{
+    mvwadd_wchnstr(canvas->window, (int)point.y, (int)point.x, cells, (int)len);
+}
+
 static void drawfv_curses(struct canvas_curses* const canvas, const struct vec2d point, const struct drawing_attr attr, const char* const format, va_list args)
 {
     WITH_DRAWING_ATTR_CURSES(attr, {
@@ -391,50 +988,399 @@ static short as_color_curses(const enum color color)
     }
 }
 
+// ansi
+
+static void write_output_ansi(struct canvas_ansi* canvas, const char* data, size_t len);
+static void writef_output_ansi(struct canvas_ansi* canvas, const char* format, ...);
+static void move_cursor_ansi(struct canvas_ansi* canvas, struct vec2d point);
+static void set_drawing_attr_ansi(struct canvas_ansi* canvas, struct drawing_attr attr);
+static unsigned int as_color_ansi(enum color color);
+
+void init_canvas_ansi(struct canvas_ansi* const canvas, const int fd)
+{
+    canvas->fd = fd;
+
+    if (!get_terminal_size(fd, &canvas->size)) {
+        canvas->size = (struct vec2d) { .x = 80, .y = 24 };
+    }
+
+    // Reserve enough room for a full repaint up front so that frames are rendered without allocation.
+    canvas->output.cap = (size_t)canvas->size.x * canvas->size.y * 4 + (1 << 10);
+    canvas->output.data = malloc(canvas->output.cap);
+    canvas->output.len = 0;
+
+    canvas->cursor.known = false;
+    canvas->attr.known = false;
+
+    if (tcgetattr(fd, &canvas->termios) == 0) {
+        struct termios termios = canvas->termios;
+        termios.c_lflag &= ~(tcflag_t)ECHO;
+        (void)tcsetattr(fd, TCSANOW, &termios);
+    }
+
+    // Enter the alternate screen, hide the cursor and clear the screen.
+    static const char setup[] = "\x1b[?1049h\x1b[?25l\x1b[0m\x1b[2J";
+    write_output_ansi(canvas, setup, sizeof(setup) - 1);
+    flush_canvas_ansi(canvas);
+}
+
+static void deinit_canvas_ansi(struct canvas_ansi* const canvas)
+{
+    // Reset the attributes, show the cursor and leave the alternate screen.
+    static const char teardown[] = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    write_output_ansi(canvas, teardown, sizeof(teardown) - 1);
+    flush_canvas_ansi(canvas);
+
+    (void)tcsetattr(canvas->fd, TCSANOW, &canvas->termios);
+
+    free(canvas->output.data);
+    canvas->output.data = NULL;
+    canvas->output.len = 0;
+    canvas->output.cap = 0;
+}
+
+static void fit_canvas_ansi(struct canvas_ansi* const canvas)
+{
+    if (!get_terminal_size(canvas->fd, &canvas->size)) {
+        return;
+    }
+
+    // Start over from the blank screen as the terminal may have reflowed what it showed.
+    clear_canvas_ansi(canvas);
+    canvas->cursor.known = false;
+}
+
+static void clear_canvas_ansi(struct canvas_ansi* const canvas)
+{
+    static const char clear[] = "\x1b[2J";
+    write_output_ansi(canvas, clear, sizeof(clear) - 1);
+}
+
+static void flush_canvas_ansi(struct canvas_ansi* const canvas)
+{
+    size_t n_written = 0;
+
+    while (n_written < canvas->output.len) {
+        errno = 0;
+        const ssize_t n = write(canvas->fd, canvas->output.data + n_written, canvas->output.len - n_written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Wait for the terminal to drain rather than spinning on the output left non-blocking, for example by another process sharing it,
+            // as a blocking output would.
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd fds[] = {
+                    { .fd = canvas->fd, .events = POLLOUT },
+                };
+                if (poll(fds, sizeof(fds) / sizeof(struct pollfd), -1) >= 0 || errno == EINTR) {
+                    continue;
+                }
+            }
+
+            // Give up the frame as a terminal which fails to be written cannot be repaired anyway.
+            break;
+        }
+
+        n_written += n;
+    }
+
+    canvas->output.len = 0;
+}
+
+static void draw_ansi(struct canvas_ansi* const canvas, const struct vec2d point, const struct drawing_attr attr, const char* const s)
+{
+    if (point.y >= canvas->size.y || point.x >= canvas->size.x) {
+        return;
+    }
+
+    move_cursor_ansi(canvas, point);
+    set_drawing_attr_ansi(canvas, attr);
+
+    unsigned int n = 0;
+    for (const char* c = s; *c && point.x + n < canvas->size.x;) {
+        const struct char_descriptor desc = decode_char_utf8(c);
+        write_output_ansi(canvas, c, desc.len);
+
+        n++;
+        c += desc.len;
+    }
+
+    canvas->cursor.point.x += n;
+    // The cursor stays at the last column instead of advancing beyond the right edge.
+    canvas->cursor.known = canvas->cursor.point.x < canvas->size.x;
+}
+
+static void draw_codes_ansi(
+    struct canvas_ansi* const canvas,
+    const struct vec2d point,
+    const struct drawing_attr attr,
+    const uint32_t* const codes, unsigned int len
+)
+{
+    if (point.y >= canvas->size.y || point.x >= canvas->size.x) {
+        return;
+    }
+
+    len = MIN(len, canvas->size.x - point.x);
+
+    move_cursor_ansi(canvas, point);
+    set_drawing_attr_ansi(canvas, attr);
+
+    for (unsigned int i = 0; i < len; i++) {
+        char c[4] = { 0 };
+        const struct char_descriptor desc = encode_char_utf8(c, codes[i]);
+        write_output_ansi(canvas, c, desc.len);
+    }
+
+    canvas->cursor.point.x += len;
+    canvas->cursor.known = canvas->cursor.point.x < canvas->size.x;
+}
+
+static void draw_data_ansi(struct canvas_ansi* const canvas, const struct vec2d point, const struct canvas_datum* const data, unsigned int len)
+{
+    if (point.y >= canvas->size.y || point.x >= canvas->size.x) {
+        return;
+    }
+
+    len = MIN(len, canvas->size.x - point.x);
+
+    move_cursor_ansi(canvas, point);
+
+    for (unsigned int i = 0; i < len; i++) {
+        const struct canvas_datum* const datum = &data[i];
+
+        set_drawing_attr_ansi(canvas, get_canvas_datum_attr(datum));
+
+        char c[4] = { 0 };
+        const struct char_descriptor desc = encode_char_utf8(c, get_canvas_datum_code(datum));
+        write_output_ansi(canvas, c, desc.len);
+    }
+
+    canvas->cursor.point.x += len;
+    canvas->cursor.known = canvas->cursor.point.x < canvas->size.x;
+}
+
+static void drawfv_ansi(struct canvas_ansi* const canvas, const struct vec2d point, const struct drawing_attr attr, const char* const format, va_list args)
+{
+    char s[1 << 8] = { 0 };
+    (void)vsnprintf(s, sizeof(s), format, args);
+    draw_ansi(canvas, point, attr, s);
+}
+
+static void write_output_ansi(struct canvas_ansi* const canvas, const char* const data, const size_t len)
+{
+    if (canvas->output.len + len > canvas->output.cap) {
+        const size_t cap = MAX(canvas->output.cap * 2, canvas->output.len + len);
+        char* const output = realloc(canvas->output.data, cap);
+        if (output == NULL) {
+            return;
+        }
+
+        canvas->output.data = output;
+        canvas->output.cap = cap;
+    }
+
+    memcpy(canvas->output.data + canvas->output.len, data, len);
+    canvas->output.len += len;
+}
+
+static void writef_output_ansi(struct canvas_ansi* const canvas, const char* const format, ...)
+{
+    char s[1 << 5] = { 0 };
+
+    va_list args = { 0 };
+    va_start(args, format);
+    const int n = vsnprintf(s, sizeof(s), format, args);
+    va_end(args);
+
+    if (n <= 0) {
+        return;
+    }
+
+    write_output_ansi(canvas, s, MIN((size_t)n, sizeof(s) - 1));
+}
+
+static void move_cursor_ansi(struct canvas_ansi* const canvas, const struct vec2d point)
+{
+    if (canvas->cursor.known && canvas->cursor.point.y == point.y) {
+        if (canvas->cursor.point.x == point.x) {
+            return;
+        }
+
+        // Moving forward in the same line is shorter than moving to the absolute position.
+        if (canvas->cursor.point.x < point.x) {
+            const unsigned int n = point.x - canvas->cursor.point.x;
+            if (n == 1) {
+                writef_output_ansi(canvas, "\x1b[C");
+            } else {
+                writef_output_ansi(canvas, "\x1b[%uC", n);
+            }
+
+            canvas->cursor.point = point;
+            return;
+        }
+    }
+
+    writef_output_ansi(canvas, "\x1b[%u;%uH", point.y + 1, point.x + 1);
+
+    canvas->cursor.known = true;
+    canvas->cursor.point = point;
+}
+
+static void set_drawing_attr_ansi(struct canvas_ansi* const canvas, const struct drawing_attr attr)
+{
+    const struct drawing_attr current = canvas->attr.value;
+
+    if (
+        canvas->attr.known
+        && current.color == attr.color
+        && current.dim == attr.dim
+        && current.bold == attr.bold
+    ) {
+        return;
+    }
+
+    // Turning off either of dim or bold turns off both of them, so reset and set all the attributes in that case.
+    const bool resets = !canvas->attr.known || (current.dim && !attr.dim) || (current.bold && !attr.bold);
+
+    char s[1 << 5] = { 0 };
+    int n = 0;
+
+    n += snprintf(s + n, sizeof(s) - n, "\x1b[");
+    if (resets) {
+        n += snprintf(s + n, sizeof(s) - n, "0;");
+    }
+    if (attr.dim && (resets || !current.dim)) {
+        n += snprintf(s + n, sizeof(s) - n, "2;");
+    }
+    if (attr.bold && (resets || !current.bold)) {
+        n += snprintf(s + n, sizeof(s) - n, "1;");
+    }
+    n += snprintf(s + n, sizeof(s) - n, "%um", as_color_ansi(attr.color));
+
+    write_output_ansi(canvas, s, MIN((size_t)n, sizeof(s) - 1));
+
+    canvas->attr.known = true;
+    canvas->attr.value = attr;
+}
+
+static unsigned int as_color_ansi(const enum color color)
+{
+    // Follow the color pairs of curses, where black is the default color of the terminal.
+    switch (color) {
+    case color_black:
+        return 39;
+    case color_red:
+        return 31;
+    case color_green:
+        return 32;
+    case color_yellow:
+        return 33;
+    case color_blue:
+        return 34;
+    case color_grey:
+        return 35;
+    case color_white:
+        return 37;
+    }
+}
+
+static bool get_terminal_size(const int fd, struct vec2d* const size)
+{
+    struct winsize winsize = { 0 };
+    if (ioctl(fd, TIOCGWINSZ, &winsize) != 0 || winsize.ws_col == 0 || winsize.ws_row == 0) {
+        return false;
+    }
+
+    *size = (struct vec2d) {
+        .x = winsize.ws_col,
+        .y = winsize.ws_row,
+    };
+
+    return true;
+}
+
 // proxy
 
-static struct canvas_buffer* serve_prev_canvas_buffer(struct canvas_proxy* canvas);
 static void switch_canvas_buffer(struct canvas_proxy* canvas);
 
-void init_canvas_proxy(struct canvas_proxy* const canvas, struct canvas_curses* const underlying)
+void init_canvas_proxy(struct canvas_proxy* const canvas, const struct canvas underlying)
 {
     canvas->underlying = underlying;
 
-    const struct vec2d size = get_canvas_size_curses(canvas->underlying);
+    const struct vec2d size = get_canvas_size(&canvas->underlying);
 
     for (int i = 0; i < CANVAS_PROXY_BUFFER_BUCKET_SIZE; i++) {
         init_canvas_buffer(&canvas->buffers[i], size);
     }
 }
 
+// NOLINTNEXTLINE(misc-no-recursion)
+static void fit_canvas_proxy(struct canvas_proxy* const canvas)
+{
+    fit_canvas(&canvas->underlying);
+
+    // The previous frame no longer tells what the underlying canvas shows, which fitting may have cleared or resized
+    // whether the buffers fit the new size or not.
+    canvas->invalidated = true;
+
+    const struct vec2d size = get_canvas_size(&canvas->underlying);
+
+    // Grow all the buffers before resizing any of them, so that they stay the same size if any of them fails to grow,
+    // in which case the next frame is repainted in full in the old size.
+    for (int i = 0; i < CANVAS_PROXY_BUFFER_BUCKET_SIZE; i++) {
+        if (!reserve_canvas_buffer(&canvas->buffers[i], size)) {
+            return;
+        }
+    }
+
+    for (int i = 0; i < CANVAS_PROXY_BUFFER_BUCKET_SIZE; i++) {
+        (void)resize_canvas_buffer(&canvas->buffers[i], size);
+    }
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 static void flush_canvas_proxy(struct canvas_proxy* const canvas)
 {
-    const struct canvas_buffer* const current = serve_current_canvas_buffer(canvas);
+    struct canvas_buffer* const current = serve_current_canvas_buffer(canvas);
     const struct canvas_buffer* const prev = serve_prev_canvas_buffer(canvas);
 
-    if (canvas_equals_buffer(current, prev)) {
-        return;
-    }
+    flush_canvas_buffer(current);
 
-    struct canvas underlying = wrap_canvas_curses(canvas->underlying);
+    if (canvas->invalidated) {
+        for (unsigned int y = 0; y < current->size.y; y++) {
+            draw_data(&canvas->underlying, (struct vec2d) { .y = y }, &current->data[y * current->size.x], current->size.x);
+        }
+
+        flush_canvas(&canvas->underlying);
 
-    clear_canvas(&underlying);
+        canvas->invalidated = false;
+        switch_canvas_buffer(canvas);
 
-    for (unsigned int y = 0; y < current->size.y; y++) {
-        for (unsigned int x = 0; x < current->size.x; x++) {
-            unsigned int i = y * current->size.x + x;
+        return;
+    }
 
-            const struct canvas_datum* const datum = &current->data[i];
+    // Send only the runs of cells that differ from the previous frame
+    // so that the underlying canvas does not repaint the whole screen on every change.
+    bool changed = false;
 
-            char c[5] = { 0 };
-            encode_char_utf8(c, datum->code);
+    struct canvas_diff_run run = { 0 };
+    for (
+        struct vec2d from = { 0 };
+        find_canvas_diff_run(current, prev, from, &run);
+        from = vec2d_add(run.point, (struct vec2d) { .x = run.len })
+    ) {
+        const unsigned int i = run.point.y * current->size.x + run.point.x;
+        draw_data(&canvas->underlying, run.point, &current->data[i], run.len);
 
-            draw(&underlying, (struct vec2d) { .y = y, .x = x }, datum->attr, c);
-        }
+        changed = true;
     }
 
-    flush_canvas(&underlying);
+    if (changed) {
+        flush_canvas(&canvas->underlying);
+    }
 
     switch_canvas_buffer(canvas);
 }
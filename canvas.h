@@ -2,6 +2,8 @@
 
 #include "math.h"
 #include <curses.h>
+#include <stddef.h>
+#include <termios.h>
 
 enum color {
     color_black,
@@ -26,38 +28,88 @@ struct drawing_ctx {
     struct vec2d current;
 };
 
+// canvas_datum is a cell packed into the index of the glyph interned in the palette
+// and the drawing attribute encoded in a byte.
 struct canvas_datum {
-    uint32_t code;
-    struct drawing_attr attr;
+    uint16_t glyph;
+    uint8_t attr;
+};
+
+// canvas_span is the range of cells [begin, end) in a row.
+struct canvas_span {
+    unsigned int begin;
+    unsigned int end;
+};
+
+struct canvas_row {
+    // epoch is the one of the buffer when the row was drawn last.
+    // The row reads as blank unless it matches the current epoch of the buffer.
+    unsigned int epoch;
+    // dirty is the span of cells which may have been drawn.
+    // Cells out of the span are always blank.
+    struct canvas_span dirty;
 };
 
 struct canvas_buffer {
     struct vec2d size;
     struct canvas_datum* data;
+
+    unsigned int epoch;
+    struct canvas_row* rows;
+
+    struct {
+        size_t data;
+        size_t rows;
+    } capacity;
+};
+
+// canvas_diff_run is a horizontal run of cells which differ between two buffers.
+struct canvas_diff_run {
+    struct vec2d point;
+    unsigned int len;
 };
 
 struct canvas_curses {
     WINDOW* window;
 };
 
-enum { CANVAS_PROXY_BUFFER_BUCKET_SIZE = 2 };
+// CANVAS_CURSES_CHUNK_LEN is the most cells the curses canvas writes in a single call.
+enum { CANVAS_CURSES_CHUNK_LEN = 1 << 8 };
 
-struct canvas_proxy {
-    unsigned int active_buffer_index;
-    struct canvas_buffer buffers[CANVAS_PROXY_BUFFER_BUCKET_SIZE];
+// canvas_ansi draws onto the terminal with ANSI escape sequences directly, without curses.
+struct canvas_ansi {
+    int fd;
+    struct termios termios;
+    struct vec2d size;
 
-    struct canvas_curses* underlying;
+    struct {
+        char* data;
+        size_t len;
+        size_t cap;
+    } output;
+
+    struct {
+        bool known;
+        struct vec2d point;
+    } cursor;
+
+    struct {
+        bool known;
+        struct drawing_attr value;
+    } attr;
 };
 
 enum canvas_type {
     canvas_buffer,
     canvas_curses,
+    canvas_ansi,
     canvas_proxy,
 };
 
 union canvas_delegate {
     struct canvas_buffer* buffer;
     struct canvas_curses* curses;
+    struct canvas_ansi* ansi;
     struct canvas_proxy* proxy;
 };
 
@@ -66,23 +118,47 @@ struct canvas {
     union canvas_delegate delegate;
 };
 
+enum { CANVAS_PROXY_BUFFER_BUCKET_SIZE = 2 };
+
+struct canvas_proxy {
+    unsigned int active_buffer_index;
+    struct canvas_buffer buffers[CANVAS_PROXY_BUFFER_BUCKET_SIZE];
+    bool invalidated;
+
+    struct canvas underlying;
+};
+
 extern struct canvas wrap_canvas_buffer(struct canvas_buffer* canvas);
 extern struct canvas wrap_canvas_curses(struct canvas_curses* canvas);
+extern struct canvas wrap_canvas_ansi(struct canvas_ansi* canvas);
 extern struct canvas wrap_canvas_proxy(struct canvas_proxy* canvas);
 
 extern void init_canvas_buffer(struct canvas_buffer* canvas, struct vec2d size);
 extern void init_canvas_curses(struct canvas_curses* canvas);
-extern void init_canvas_proxy(struct canvas_proxy* canvas, struct canvas_curses* underlying);
+extern void init_canvas_ansi(struct canvas_ansi* canvas, int fd);
+extern void init_canvas_proxy(struct canvas_proxy* canvas, struct canvas underlying);
 
 extern void deinit_canvas(struct canvas* canvas);
 
+extern void fit_canvas(struct canvas* canvas);
+
 extern void clear_canvas(struct canvas* canvas);
 extern void flush_canvas(struct canvas* canvas);
 
 extern void draw(struct canvas* canvas, struct vec2d point, struct drawing_attr attr, const char* s);
+extern void draw_cell(struct canvas* canvas, struct vec2d point, struct drawing_attr attr, uint32_t code);
+extern void draw_codes(struct canvas* canvas, struct vec2d point, struct drawing_attr attr, const uint32_t* codes, unsigned int len);
 extern void drawfv(struct canvas* canvas, struct vec2d point, struct drawing_attr attr, const char* format, va_list args);
 extern void drawf(struct canvas* canvas, struct vec2d point, struct drawing_attr attr, const char* format, ...);
+extern void blit(struct canvas* canvas, struct vec2d point, const struct canvas_buffer* sprite);
 
 extern struct vec2d get_canvas_size(const struct canvas* canvas);
 
+extern uint32_t get_canvas_buffer_code(const struct canvas_buffer* canvas, struct vec2d point);
+
+extern bool find_canvas_diff_run(
+    const struct canvas_buffer* canvas, const struct canvas_buffer* other,
+    struct vec2d from, struct canvas_diff_run* run
+);
+
 extern void wrap_drawing_lines(struct drawing_ctx* ctx, unsigned int n);
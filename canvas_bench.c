@@ -0,0 +1,133 @@
+#include "canvas.h"
+
+#include "bench.h"
+#include "ccodoc.h"
+#include "renderer.h"
+#include <stdio.h>
+
+struct presentation_stats {
+    unsigned long frames;
+    unsigned long changed_frames;
+    unsigned long changed_cells;
+    unsigned long runs;
+    // chunks counts the chunks the runs are written in, each with a single call.
+    unsigned long chunks;
+};
+
+static struct presentation_stats present_frames(struct vec2d size, unsigned int frames, struct duration delta);
+
+void bench_canvas(void)
+{
+    printf("## estimated curses calls per frame (ccodoc in wabi, 25 fps for 30 secs)\n");
+
+    static const struct vec2d sizes[] = {
+        { .x = 80, .y = 24 },
+        { .x = 300, .y = 90 },
+    };
+    static const size_t sizes_len = sizeof(sizes) / sizeof(struct vec2d);
+
+    static const struct duration delta = { .nsecs = NSECS_FROM_MSECS(1000 / 25) };
+    static const unsigned int frames = 30 * 25;
+
+    for (size_t i = 0; i < sizes_len; i++) {
+        const struct vec2d size = sizes[i];
+
+        const struct presentation_stats stats = present_frames(size, frames, delta);
+
+        // The calls are estimated from the diffs between the frames rather than counted on a terminal.
+        // The per-cell path issues attron, mvwprintw and attroff for every changed cell,
+        // while the run-batched path issues a mvwadd_wchnstr for every chunk of a run of changed cells.
+        // Both issue a refresh for every changed frame.
+        const unsigned long calls_per_cell = 3 * stats.changed_cells + stats.changed_frames;
+        const unsigned long calls_per_run = stats.chunks + stats.changed_frames;
+
+        printf("%ux%u:\n", size.x, size.y);
+        printf("  changed frames: %lu/%lu\n", stats.changed_frames, stats.frames);
+        printf("  runs: %lu, chunks: %lu\n", stats.runs, stats.chunks);
+        printf("  per-cell: %.2f calls/frame\n", (double)calls_per_cell / (double)stats.frames);
+        printf("  run-batched: %.2f calls/frame\n", (double)calls_per_run / (double)stats.frames);
+    }
+}
+
+static struct presentation_stats present_frames(const struct vec2d size, const unsigned int frames, const struct duration delta)
+{
+    struct presentation_stats stats = { 0 };
+
+    struct canvas_buffer buffers[2] = { 0 };
+    for (size_t i = 0; i < 2; i++) {
+        init_canvas_buffer(&buffers[i], size);
+    }
+
+    struct ccodoc ccodoc = {
+        .kakehi = {
+            .release_water_amount = 1,
+            .holding_water = {
+                .duration = { .nsecs = NSECS_FROM_MSECS(2200) },
+            },
+            .releasing_water = {
+                .duration = { .nsecs = NSECS_FROM_MSECS(800) },
+            },
+        },
+        .tsutsu = {
+            .water_capacity = 10,
+            .releasing_water = {
+                .duration = { .nsecs = NSECS_FROM_MSECS(1200) },
+            },
+        },
+        .hachi = {
+            .releasing_water = {
+                .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
+            },
+        },
+    };
+
+    struct renderer renderer = { 0 };
+    init_renderer(&renderer, NULL, true);
+
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        struct canvas_buffer* const current = &buffers[frame % 2];
+        const struct canvas_buffer* const prev = &buffers[(frame + 1) % 2];
+
+        tick_ccodoc(&ccodoc, delta);
+
+        struct canvas canvas = wrap_canvas_buffer(current);
+        renderer.canvas = &canvas;
+
+        RENDER(&renderer, {
+            struct drawing_ctx ctx = {
+                .origin = { .x = (size.x - 14) / 2, .y = (size.y - 6) / 2 },
+            };
+            ctx.current = ctx.origin;
+
+            render_ccodoc(&renderer, &ctx, &ccodoc);
+        });
+
+        unsigned long runs = 0;
+
+        struct canvas_diff_run run = { 0 };
+        for (
+            struct vec2d from = { 0 };
+            find_canvas_diff_run(current, prev, from, &run);
+            from = vec2d_add(run.point, (struct vec2d) { .x = run.len })
+        ) {
+            runs++;
+            stats.changed_cells += run.len;
+            stats.chunks += (run.len + CANVAS_CURSES_CHUNK_LEN - 1) / CANVAS_CURSES_CHUNK_LEN;
+        }
+
+        stats.frames++;
+        stats.runs += runs;
+        if (runs != 0) {
+            stats.changed_frames++;
+        }
+    }
+
+    deinit_renderer(&renderer);
+
+    for (size_t i = 0; i < 2; i++) {
+        struct canvas canvas = wrap_canvas_buffer(&buffers[i]);
+        deinit_canvas(&canvas);
+    }
+
+    return stats;
+}
@@ -4,10 +4,22 @@
 #include "time.h"
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
 
-static void tick_kakehi(struct ccodoc* ccodoc, struct duration delta);
-static void tick_tsutsu(struct ccodoc* ccodoc, struct duration delta);
-static void tick_hachi(struct ccodoc* ccodoc, struct duration delta);
+static void sync_scheduler(struct ccodoc* ccodoc);
+static void advance_scheduler(struct ccodoc* ccodoc, struct duration time);
+static void finish_scheduled_action(struct ccodoc* ccodoc, enum scheduled_action_type type);
+
+static void schedule_action(struct ccodoc* ccodoc, enum scheduled_action_type type);
+static void unschedule_action(struct ccodoc* ccodoc, enum scheduled_action_type type);
+static bool action_is_scheduled(const struct action_scheduler* scheduler, enum scheduled_action_type type);
+static action_t* get_scheduled_action(struct ccodoc* ccodoc, enum scheduled_action_type type);
+
+static void push_scheduled_action(struct action_scheduler* scheduler, struct scheduled_action action);
+static void remove_scheduled_action(struct action_scheduler* scheduler, unsigned int i);
+static void sift_scheduled_action_up(struct action_scheduler* scheduler, unsigned int i);
+static void sift_scheduled_action_down(struct action_scheduler* scheduler, unsigned int i);
+static bool scheduled_action_precedes(struct scheduled_action action, struct scheduled_action other);
 
 static void hold_water_kakehi(struct ccodoc* ccodoc);
 static void release_water_kakehi(struct ccodoc* ccodoc);
@@ -20,103 +32,306 @@ static void release_water_hachi(struct ccodoc* ccodoc);
 
 static void drip_water_into_tsutsu(struct tsutsu* tsutsu, unsigned int amount);
 
+static bool ccodoc_state_equals(const struct ccodoc* ccodoc, const struct ccodoc* other);
+
+// tick_ccodoc moves the ccodoc on by the delta, finishing the actions whose deadlines fall within the delta
+// in the order of their deadlines.
+// The actions following them start at the deadlines, so that ticking by a delta at once or in pieces ends up the same.
 void tick_ccodoc(struct ccodoc* const ccodoc, const struct duration delta)
 {
-    tick_kakehi(ccodoc, delta);
-    tick_tsutsu(ccodoc, delta);
-    tick_hachi(ccodoc, delta);
+    sync_scheduler(ccodoc);
+
+    struct action_scheduler* const scheduler = &ccodoc->scheduler;
+    const struct duration end = { .nsecs = scheduler->time.nsecs + delta.nsecs };
+
+    while (scheduler->len > 0 && scheduler->actions[0].deadline.nsecs <= end.nsecs) {
+        const struct scheduled_action action = scheduler->actions[0];
+
+        advance_scheduler(ccodoc, action.deadline);
+        remove_scheduled_action(scheduler, 0);
+
+        finish_scheduled_action(ccodoc, action.type);
+    }
+
+    advance_scheduler(ccodoc, end);
 }
 
-static void tick_kakehi(struct ccodoc* const ccodoc, struct duration delta)
+// fast_forward_ccodoc moves the ccodoc on by the delta as ticking does, in time independent of the delta.
+// It ticks from deadline to deadline, and skips the whole cycles of the ccodoc
+// once it comes back to the same state where the tsutsu releases water.
+// The listeners are not notified of the events in the skipped cycles.
+void fast_forward_ccodoc(struct ccodoc* const ccodoc, const struct duration delta)
 {
-    struct kakehi* const kakehi = &ccodoc->kakehi;
+    sync_scheduler(ccodoc);
 
-    if (kakehi->disabled) {
-        return;
-    }
+    uint64_t remaining = delta.nsecs;
 
-    static struct duration carried_delta = { 0 };
+    struct {
+        bool found;
+        struct ccodoc ccodoc;
+        uint64_t remaining;
+    } cycle = { 0 };
 
-    delta.msecs += carried_delta.msecs;
-    carried_delta.msecs = 0;
+    while (remaining > 0) {
+        const struct action_scheduler* const scheduler = &ccodoc->scheduler;
+        const uint64_t until = scheduler->len > 0
+            ? MIN(duration_diff(scheduler->actions[0].deadline, scheduler->time).nsecs, remaining)
+            : remaining;
 
-    switch (kakehi->state) {
-    case holding_water:
-        tick_action(&kakehi->holding_water, delta);
+        const enum water_flow_state tsutsu_last_state = ccodoc->tsutsu.state;
+        tick_ccodoc(ccodoc, (struct duration) { .nsecs = until });
 
-        if (!action_has_finished(&kakehi->holding_water)) {
-            return;
+        remaining -= until;
+
+        if (tsutsu_last_state == releasing_water || ccodoc->tsutsu.state != releasing_water) {
+            continue;
         }
 
-        release_water_kakehi(ccodoc);
+        if (cycle.found && ccodoc_state_equals(ccodoc, &cycle.ccodoc)) {
+            remaining %= cycle.remaining - remaining;
+        }
 
-        carried_delta = get_overflow_time(&kakehi->holding_water);
+        cycle.found = true;
+        cycle.ccodoc = *ccodoc;
+        cycle.remaining = remaining;
+    }
+}
 
-        break;
-    case releasing_water:
-        tick_action(&kakehi->releasing_water, delta);
+// sync_scheduler schedules the actions going on and unschedules the ones paused,
+// which catches up with the ccodoc set up or changed from outside, such as the kakehi disabled.
+static void sync_scheduler(struct ccodoc* const ccodoc)
+{
+    {
+        const struct kakehi* const kakehi = &ccodoc->kakehi;
 
-        if (!action_has_finished(&kakehi->releasing_water)) {
-            return;
+        const enum scheduled_action_type type = kakehi->state == holding_water
+            ? scheduled_kakehi_holding_water
+            : scheduled_kakehi_releasing_water;
+
+        if (kakehi->disabled) {
+            unschedule_action(ccodoc, type);
+        } else if (!action_is_scheduled(&ccodoc->scheduler, type)) {
+            schedule_action(ccodoc, type);
         }
+    }
 
-        hold_water_kakehi(ccodoc);
+    {
+        const struct tsutsu* const tsutsu = &ccodoc->tsutsu;
 
-        carried_delta = get_overflow_time(&kakehi->releasing_water);
+        switch (tsutsu->state) {
+        case holding_water:
+            if (get_tsutsu_water_amount_ratio(tsutsu) >= 1) {
+                release_water_tsutsu(ccodoc);
+            }
+            break;
+        case releasing_water:
+            if (!action_is_scheduled(&ccodoc->scheduler, scheduled_tsutsu_releasing_water)) {
+                schedule_action(ccodoc, scheduled_tsutsu_releasing_water);
+            }
+            break;
+        }
+    }
 
-        break;
+    if (ccodoc->hachi.state == releasing_water && !action_is_scheduled(&ccodoc->scheduler, scheduled_hachi_releasing_water)) {
+        schedule_action(ccodoc, scheduled_hachi_releasing_water);
     }
 }
 
-static void tick_tsutsu(struct ccodoc* const ccodoc, const struct duration delta)
+// advance_scheduler moves the actions scheduled on to the time, which must not pass any of their deadlines.
+static void advance_scheduler(struct ccodoc* const ccodoc, const struct duration time)
 {
-    struct tsutsu* const tsutsu = &ccodoc->tsutsu;
+    struct action_scheduler* const scheduler = &ccodoc->scheduler;
 
-    switch (tsutsu->state) {
-    case holding_water:
-        if (get_tsutsu_water_amount_ratio(tsutsu) < 1) {
-            break;
-        }
+    const struct duration delta = duration_diff(time, scheduler->time);
+    for (unsigned int i = 0; i < scheduler->len; i++) {
+        tick_action(get_scheduled_action(ccodoc, scheduler->actions[i].type), delta);
+    }
 
-        release_water_tsutsu(ccodoc);
+    scheduler->time = time;
+}
 
+static void finish_scheduled_action(struct ccodoc* const ccodoc, const enum scheduled_action_type type)
+{
+    switch (type) {
+    case scheduled_kakehi_holding_water:
+        release_water_kakehi(ccodoc);
+        break;
+    case scheduled_kakehi_releasing_water:
+        hold_water_kakehi(ccodoc);
         break;
-    case releasing_water: {
-        tick_action(&tsutsu->releasing_water, delta);
+    case scheduled_tsutsu_releasing_water:
+        notify_listener(&ccodoc->tsutsu.on_bumped);
+        hold_water_tsutsu(ccodoc);
+        break;
+    case scheduled_hachi_releasing_water:
+        hold_water_hachi(ccodoc);
+        break;
+    }
+}
 
-        if (!action_has_finished(&tsutsu->releasing_water)) {
-            break;
+// schedule_action schedules the action to finish once the rest of it passes from now.
+static void schedule_action(struct ccodoc* const ccodoc, const enum scheduled_action_type type)
+{
+    unschedule_action(ccodoc, type);
+
+    // The actions of no duration are given a msec, as the actions following one another without time passing,
+    // such as the kakehi which takes no time to hold and release water, would keep the scheduler from getting past them.
+    // The actions themselves are left as they are.
+    static const struct duration min_step = { .nsecs = NSECS_FROM_MSECS(1) };
+
+    struct action_scheduler* const scheduler = &ccodoc->scheduler;
+    const action_t* const action = get_scheduled_action(ccodoc, type);
+    const struct duration remaining = action->duration.nsecs != 0 ? get_remaining_time(action) : min_step;
+
+    push_scheduled_action(
+        scheduler,
+        (struct scheduled_action) {
+            .type = type,
+            .deadline = { .nsecs = scheduler->time.nsecs + remaining.nsecs },
         }
+    );
+}
 
-        notify_listener(&tsutsu->on_bumped);
+static void unschedule_action(struct ccodoc* const ccodoc, const enum scheduled_action_type type)
+{
+    struct action_scheduler* const scheduler = &ccodoc->scheduler;
 
-        hold_water_tsutsu(ccodoc);
+    for (unsigned int i = 0; i < scheduler->len; i++) {
+        if (scheduler->actions[i].type == type) {
+            remove_scheduled_action(scheduler, i);
+            return;
+        }
+    }
+}
 
-        break;
+static bool action_is_scheduled(const struct action_scheduler* const scheduler, const enum scheduled_action_type type)
+{
+    for (unsigned int i = 0; i < scheduler->len; i++) {
+        if (scheduler->actions[i].type == type) {
+            return true;
+        }
     }
+
+    return false;
+}
+
+static action_t* get_scheduled_action(struct ccodoc* const ccodoc, const enum scheduled_action_type type)
+{
+    switch (type) {
+    case scheduled_kakehi_holding_water:
+        return &ccodoc->kakehi.holding_water;
+    case scheduled_kakehi_releasing_water:
+        return &ccodoc->kakehi.releasing_water;
+    case scheduled_tsutsu_releasing_water:
+        return &ccodoc->tsutsu.releasing_water;
+    case scheduled_hachi_releasing_water:
+        return &ccodoc->hachi.releasing_water;
     }
 }
 
-static void tick_hachi(struct ccodoc* const ccodoc, const struct duration delta)
+static void push_scheduled_action(struct action_scheduler* const scheduler, const struct scheduled_action action)
 {
-    struct hachi* const hachi = &ccodoc->hachi;
+    assert(scheduler->len < scheduled_action_types_len);
 
-    switch (hachi->state) {
-    case holding_water:
-        break;
-    case releasing_water:
-        tick_action(&hachi->releasing_water, delta);
+    scheduler->actions[scheduler->len] = action;
+    scheduler->len++;
 
-        if (!action_has_finished(&hachi->releasing_water)) {
-            break;
+    sift_scheduled_action_up(scheduler, scheduler->len - 1);
+}
+
+static void remove_scheduled_action(struct action_scheduler* const scheduler, const unsigned int i)
+{
+    assert(i < scheduler->len);
+
+    scheduler->len--;
+    if (i == scheduler->len) {
+        return;
+    }
+
+    scheduler->actions[i] = scheduler->actions[scheduler->len];
+
+    sift_scheduled_action_up(scheduler, i);
+    sift_scheduled_action_down(scheduler, i);
+}
+
+static void sift_scheduled_action_up(struct action_scheduler* const scheduler, unsigned int i)
+{
+    struct scheduled_action* const actions = scheduler->actions;
+
+    while (i > 0) {
+        const unsigned int parent = (i - 1) / 2;
+        if (!scheduled_action_precedes(actions[i], actions[parent])) {
+            return;
         }
 
-        hold_water_hachi(ccodoc);
+        const struct scheduled_action action = actions[i];
+        actions[i] = actions[parent];
+        actions[parent] = action;
 
-        break;
+        i = parent;
+    }
+}
+
+static void sift_scheduled_action_down(struct action_scheduler* const scheduler, unsigned int i)
+{
+    struct scheduled_action* const actions = scheduler->actions;
+
+    while (true) {
+        unsigned int first = i;
+
+        const unsigned int left = 2 * i + 1;
+        if (left < scheduler->len && scheduled_action_precedes(actions[left], actions[first])) {
+            first = left;
+        }
+
+        const unsigned int right = 2 * i + 2;
+        if (right < scheduler->len && scheduled_action_precedes(actions[right], actions[first])) {
+            first = right;
+        }
+
+        if (first == i) {
+            return;
+        }
+
+        const struct scheduled_action action = actions[i];
+        actions[i] = actions[first];
+        actions[first] = action;
+
+        i = first;
     }
 }
 
+static bool scheduled_action_precedes(const struct scheduled_action action, const struct scheduled_action other)
+{
+    if (action.deadline.nsecs != other.deadline.nsecs) {
+        return action.deadline.nsecs < other.deadline.nsecs;
+    }
+
+    return action.type < other.type;
+}
+
+static bool ccodoc_state_equals(const struct ccodoc* const ccodoc, const struct ccodoc* const other)
+{
+    const struct kakehi* const kakehi = &ccodoc->kakehi;
+    const struct kakehi* const other_kakehi = &other->kakehi;
+
+    const struct tsutsu* const tsutsu = &ccodoc->tsutsu;
+    const struct tsutsu* const other_tsutsu = &other->tsutsu;
+
+    const struct hachi* const hachi = &ccodoc->hachi;
+    const struct hachi* const other_hachi = &other->hachi;
+
+    return kakehi->state == other_kakehi->state
+        && kakehi->disabled == other_kakehi->disabled
+        && kakehi->holding_water.ticker.elapsed.nsecs == other_kakehi->holding_water.ticker.elapsed.nsecs
+        && kakehi->releasing_water.ticker.elapsed.nsecs == other_kakehi->releasing_water.ticker.elapsed.nsecs
+        && tsutsu->state == other_tsutsu->state
+        && tsutsu->water_amount == other_tsutsu->water_amount
+        && tsutsu->releasing_water.ticker.elapsed.nsecs == other_tsutsu->releasing_water.ticker.elapsed.nsecs
+        && hachi->state == other_hachi->state
+        && hachi->releasing_water.ticker.elapsed.nsecs == other_hachi->releasing_water.ticker.elapsed.nsecs;
+}
+
 static void hold_water_kakehi(struct ccodoc* const ccodoc)
 {
     struct kakehi* const kakehi = &ccodoc->kakehi;
@@ -128,6 +343,7 @@ static void hold_water_kakehi(struct ccodoc* const ccodoc)
 
     kakehi->state = state;
     reset_action(&kakehi->holding_water);
+    schedule_action(ccodoc, scheduled_kakehi_holding_water);
 }
 
 static void release_water_kakehi(struct ccodoc* const ccodoc)
@@ -141,8 +357,13 @@ static void release_water_kakehi(struct ccodoc* const ccodoc)
 
     kakehi->state = state;
     reset_action(&kakehi->releasing_water);
+    schedule_action(ccodoc, scheduled_kakehi_releasing_water);
 
     drip_water_into_tsutsu(&ccodoc->tsutsu, kakehi->release_water_amount);
+
+    if (ccodoc->tsutsu.state == holding_water && get_tsutsu_water_amount_ratio(&ccodoc->tsutsu) >= 1) {
+        release_water_tsutsu(ccodoc);
+    }
 }
 
 static void hold_water_tsutsu(struct ccodoc* const ccodoc)
@@ -169,6 +390,7 @@ static void release_water_tsutsu(struct ccodoc* const ccodoc)
 
     tsutsu->state = state;
     reset_action(&tsutsu->releasing_water);
+    schedule_action(ccodoc, scheduled_tsutsu_releasing_water);
 
     tsutsu->water_amount = 0;
 
@@ -198,6 +420,7 @@ static void release_water_hachi(struct ccodoc* const ccodoc)
 
     hachi->state = state;
     reset_action(&hachi->releasing_water);
+    schedule_action(ccodoc, scheduled_hachi_releasing_water);
 }
 
 static void drip_water_into_tsutsu(struct tsutsu* const tsutsu, const unsigned int amount)
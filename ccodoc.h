@@ -47,14 +47,41 @@ struct hachi {
     action_t releasing_water;
 };
 
+enum scheduled_action_type {
+    scheduled_kakehi_holding_water,
+    scheduled_kakehi_releasing_water,
+    scheduled_tsutsu_releasing_water,
+    scheduled_hachi_releasing_water,
+};
+
+enum { scheduled_action_types_len = 4 };
+
+struct scheduled_action {
+    enum scheduled_action_type type;
+    struct duration deadline;
+};
+
+// action_scheduler keeps the actions going on in a min-heap ordered by their deadlines,
+// which are measured from the time the scheduler started.
+// The actions with the same deadline are ordered by their types, from the kakehi down to the hachi as the water flows.
+struct action_scheduler {
+    struct duration time;
+
+    struct scheduled_action actions[scheduled_action_types_len];
+    unsigned int len;
+};
+
 // ccodoc（鹿威し）
 struct ccodoc {
     struct kakehi kakehi;
     struct tsutsu tsutsu;
     struct hachi hachi;
+
+    struct action_scheduler scheduler;
 };
 
 extern void tick_ccodoc(struct ccodoc* ccodoc, struct duration delta);
+extern void fast_forward_ccodoc(struct ccodoc* ccodoc, struct duration delta);
 
 extern float get_tsutsu_water_amount_ratio(const struct tsutsu* tsutsu);
 
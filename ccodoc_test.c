@@ -1,6 +1,7 @@
 #include "ccodoc.h"
 
 #include "test.h"
+#include <inttypes.h>
 #include <stdio.h>
 
 struct ccodoc_state {
@@ -25,33 +26,36 @@ struct ccodoc_state {
 static int expect_tick_ccodoc(const char* file, int line, struct duration delta, struct ccodoc* ccodoc, struct ccodoc_state expected);
 #define EXPECT_TICK_CCODOC(delta, ccodoc, expected) EXPECT_PASS(expect_tick_ccodoc(__FILE__, __LINE__, delta, ccodoc, expected))
 
+static int expect_fast_forward_ccodoc(const char* file, int line, struct duration delta, struct ccodoc* ccodoc, struct ccodoc* ticked);
+#define EXPECT_FAST_FORWARD_CCODOC(delta, ccodoc, ticked) EXPECT_PASS(expect_fast_forward_ccodoc(__FILE__, __LINE__, delta, ccodoc, ticked))
+
 int test_ccodoc(void)
 {
     struct ccodoc ccodoc = {
         .kakehi = {
             .release_water_amount = 5,
             .holding_water = {
-                .duration = { .msecs = 2500 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(2500) },
             },
             .releasing_water = {
-                .duration = { .msecs = 500 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(500) },
             },
         },
         .tsutsu = {
             .water_capacity = 10,
             .releasing_water = {
-                .duration = { .msecs = 1500 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(1500) },
             },
         },
         .hachi = {
             .releasing_water = {
-                .duration = { .msecs = 1000 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
             },
         },
     };
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 0 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(0) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0, .releasing_water_ratio = 0 },
@@ -61,7 +65,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 250 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(250) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0.1, .releasing_water_ratio = 0 },
@@ -71,7 +75,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 1750 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(1750) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0.8, .releasing_water_ratio = 0 },
@@ -81,7 +85,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 500 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(500) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 0 },
@@ -91,7 +95,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 250 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(250) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 0.5 },
@@ -101,7 +105,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 250 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(250) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0, .releasing_water_ratio = 1 },
@@ -111,7 +115,7 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 2000 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(2000) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0.8, .releasing_water_ratio = 1 },
@@ -121,37 +125,37 @@ int test_ccodoc(void)
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 500 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(500) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 0 },
             .tsutsu = { .state = releasing_water, .water_amount_ratio = 0, .releasing_water_ratio = 0 },
-            .hachi = { .state = releasing_water, .releasing_water_ratio = 0.5 },
+            .hachi = { .state = releasing_water, .releasing_water_ratio = 0 },
         })
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 250 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(250) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 0.5 },
             .tsutsu = { .state = releasing_water, .water_amount_ratio = 0, .releasing_water_ratio = 1.0 / 6 },
-            .hachi = { .state = releasing_water, .releasing_water_ratio = 0.75 },
+            .hachi = { .state = releasing_water, .releasing_water_ratio = 0.25 },
         })
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 250 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(250) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0, .releasing_water_ratio = 1 },
             .tsutsu = { .state = releasing_water, .water_amount_ratio = 0, .releasing_water_ratio = 1.0 / 3 },
-            .hachi = { .state = holding_water, .releasing_water_ratio = 1 },
+            .hachi = { .state = releasing_water, .releasing_water_ratio = 0.5 },
         })
     );
 
     EXPECT_TICK_CCODOC(
-        ((struct duration) { .msecs = 1000 }),
+        ((struct duration) { .nsecs = NSECS_FROM_MSECS(1000) }),
         &ccodoc,
         ((struct ccodoc_state) {
             .kakehi = { .state = holding_water, .holding_water_ratio = 0.4, .releasing_water_ratio = 1 },
@@ -160,6 +164,151 @@ int test_ccodoc(void)
         })
     );
 
+    {
+        // The kakehi takes no time to hold and release water, which the scheduler gives a msec each.
+        // Its actions stay of no duration, which count as having finished all along.
+        struct ccodoc ccodoc = {
+            .kakehi = {
+                .release_water_amount = 5,
+                .holding_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(0) },
+                },
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(0) },
+                },
+            },
+            .tsutsu = {
+                .water_capacity = 10,
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1500) },
+                },
+            },
+            .hachi = {
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
+                },
+            },
+        };
+
+        EXPECT_TICK_CCODOC(
+            ((struct duration) { .nsecs = NSECS_FROM_MSECS(0) }),
+            &ccodoc,
+            ((struct ccodoc_state) {
+                .kakehi = { .state = holding_water, .holding_water_ratio = 1, .releasing_water_ratio = 1 },
+                .tsutsu = { .state = holding_water, .water_amount_ratio = 0, .releasing_water_ratio = 0 },
+                .hachi = { .state = holding_water, .releasing_water_ratio = 0 },
+            })
+        );
+
+        EXPECT_TICK_CCODOC(
+            ((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }),
+            &ccodoc,
+            ((struct ccodoc_state) {
+                .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 1 },
+                .tsutsu = { .state = holding_water, .water_amount_ratio = 0.5, .releasing_water_ratio = 0 },
+                .hachi = { .state = holding_water, .releasing_water_ratio = 0 },
+            })
+        );
+
+        EXPECT_TICK_CCODOC(
+            ((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }),
+            &ccodoc,
+            ((struct ccodoc_state) {
+                .kakehi = { .state = holding_water, .holding_water_ratio = 1, .releasing_water_ratio = 1 },
+                .tsutsu = { .state = holding_water, .water_amount_ratio = 0.5, .releasing_water_ratio = 0 },
+                .hachi = { .state = holding_water, .releasing_water_ratio = 0 },
+            })
+        );
+
+        EXPECT_TICK_CCODOC(
+            ((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }),
+            &ccodoc,
+            ((struct ccodoc_state) {
+                .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 1 },
+                .tsutsu = { .state = releasing_water, .water_amount_ratio = 0, .releasing_water_ratio = 0 },
+                .hachi = { .state = releasing_water, .releasing_water_ratio = 0 },
+            })
+        );
+
+        EXPECT_TICK_CCODOC(
+            ((struct duration) { .nsecs = NSECS_FROM_MSECS(1000) }),
+            &ccodoc,
+            ((struct ccodoc_state) {
+                .kakehi = { .state = releasing_water, .holding_water_ratio = 1, .releasing_water_ratio = 1 },
+                .tsutsu = { .state = releasing_water, .water_amount_ratio = 1, .releasing_water_ratio = 2.0 / 3 },
+                .hachi = { .state = holding_water, .releasing_water_ratio = 1 },
+            })
+        );
+
+        struct ccodoc ticked = ccodoc;
+        EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(12345) }), &ccodoc, &ticked);
+
+        {
+            char actual[1 << 6] = { 0 };
+            (void)snprintf(
+                actual, sizeof(actual),
+                "%" PRIu64 "/%" PRIu64 " nsecs",
+                ccodoc.kakehi.holding_water.duration.nsecs, ccodoc.kakehi.releasing_water.duration.nsecs
+            );
+
+            const bool passes = ccodoc.kakehi.holding_water.duration.nsecs == 0 && ccodoc.kakehi.releasing_water.duration.nsecs == 0;
+            report_status(__FILE__, __LINE__, passes, "leaves the durations as they are", actual, "0/0 nsecs");
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    {
+        static const struct ccodoc ccodocs[] = {
+            {
+                .kakehi = {
+                    .release_water_amount = 1,
+                    .holding_water = { .duration = { .nsecs = NSECS_FROM_MSECS(2200) } },
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(800) } },
+                },
+                .tsutsu = {
+                    .water_capacity = 10,
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(1200) } },
+                },
+                .hachi = {
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(1000) } },
+                },
+            },
+            // The kakehi drips while the tsutsu releases water, and the hachi outlasts the tsutsu.
+            {
+                .kakehi = {
+                    .release_water_amount = 3,
+                    .holding_water = { .duration = { .nsecs = NSECS_FROM_MSECS(170) } },
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(90) } },
+                },
+                .tsutsu = {
+                    .water_capacity = 10,
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(530) } },
+                },
+                .hachi = {
+                    .releasing_water = { .duration = { .nsecs = NSECS_FROM_MSECS(1100) } },
+                },
+            },
+        };
+        static const size_t ccodocs_len = sizeof(ccodocs) / sizeof(struct ccodoc);
+
+        for (size_t i = 0; i < ccodocs_len; i++) {
+            struct ccodoc ccodoc = ccodocs[i];
+            struct ccodoc ticked = ccodocs[i];
+
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(0) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(733) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(2200) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(29999) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(12345) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS((long)1 * time_hour) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }), &ccodoc, &ticked);
+            EXPECT_FAST_FORWARD_CCODOC(((struct duration) { .nsecs = NSECS_FROM_MSECS((long)7 * time_min + 777) }), &ccodoc, &ticked);
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -185,7 +334,7 @@ static int expect_tick_ccodoc(
 {
     tick_ccodoc(ccodoc, delta);
 
-    printf("- tick: %ld msecs =>\n", delta.msecs);
+    printf("- tick: %" PRIu64 " msecs =>\n", msecs_from_duration(delta));
     EXPECT_PASS(expect_kakehi(file, line, &ccodoc->kakehi, expected.kakehi));
     EXPECT_PASS(expect_tsutsu(file, line, &ccodoc->tsutsu, expected.tsutsu));
     EXPECT_PASS(expect_hachi(file, line, &ccodoc->hachi, expected.hachi));
@@ -193,6 +342,50 @@ static int expect_tick_ccodoc(
     return EXIT_SUCCESS;
 }
 
+static struct ccodoc_state get_ccodoc_state(const struct ccodoc* ccodoc);
+
+static int expect_fast_forward_ccodoc(
+    const char* const file, const int line,
+    const struct duration delta,
+    struct ccodoc* const ccodoc, struct ccodoc* const ticked
+)
+{
+    fast_forward_ccodoc(ccodoc, delta);
+
+    for (uint64_t i = 0; i < msecs_from_duration(delta); i++) {
+        tick_ccodoc(ticked, (struct duration) { .nsecs = NSECS_FROM_MSECS(1) });
+    }
+
+    const struct ccodoc_state expected = get_ccodoc_state(ticked);
+
+    printf("- fast forward: %" PRIu64 " msecs =>\n", msecs_from_duration(delta));
+    EXPECT_PASS(expect_kakehi(file, line, &ccodoc->kakehi, expected.kakehi));
+    EXPECT_PASS(expect_tsutsu(file, line, &ccodoc->tsutsu, expected.tsutsu));
+    EXPECT_PASS(expect_hachi(file, line, &ccodoc->hachi, expected.hachi));
+
+    return EXIT_SUCCESS;
+}
+
+static struct ccodoc_state get_ccodoc_state(const struct ccodoc* const ccodoc)
+{
+    return (struct ccodoc_state) {
+        .kakehi = {
+            .state = ccodoc->kakehi.state,
+            .holding_water_ratio = get_action_progress_ratio(&ccodoc->kakehi.holding_water),
+            .releasing_water_ratio = get_action_progress_ratio(&ccodoc->kakehi.releasing_water),
+        },
+        .tsutsu = {
+            .state = ccodoc->tsutsu.state,
+            .water_amount_ratio = get_tsutsu_water_amount_ratio(&ccodoc->tsutsu),
+            .releasing_water_ratio = get_action_progress_ratio(&ccodoc->tsutsu.releasing_water),
+        },
+        .hachi = {
+            .state = ccodoc->hachi.state,
+            .releasing_water_ratio = get_action_progress_ratio(&ccodoc->hachi.releasing_water),
+        },
+    };
+}
+
 static int expect_kakehi(const char* const file, const int line, const struct kakehi* const kakehi, const struct kakehi_state expected)
 {
     const struct kakehi_state actual = {
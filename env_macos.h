@@ -1,6 +1,8 @@
 #pragma once
 
 #define _POSIX_C_SOURCE 200809L
+// Expose BSD extensions such as SIGWINCH and TIOCGWINSZ, which strict POSIX mode hides.
+#define _DARWIN_C_SOURCE
 
 #include "platform.h" // IWYU pragma: keep
 
@@ -2,6 +2,7 @@
 #include "platform.h"
 #include "string.h"
 #include "time.h"
+#include <math.h>
 #include <signal.h>
 #include <stdlib.h>
 
@@ -28,6 +29,7 @@ int main(const int argc, const char* const* const argv)
     struct mode mode = {
         .ornamental = true,
         .debug = false,
+        .speed = 1,
     };
 
     struct config config = {
@@ -72,6 +74,12 @@ static const char* config_err_no_value_specified(const char* name);
 
 static const char* configure(struct config* const config, const unsigned int argc, const char* const* const argv)
 {
+    // Terminals hardly keep up with more frames than this.
+    static const unsigned int max_fps = 240;
+    // Out of these, a frame either takes years in the mode to step through or rounds down to no time at all.
+    static const double min_speed = 0.01;
+    static const double max_speed = 10000;
+
     for (unsigned int i = 1; i < argc; i++) {
         const char* const arg = argv[i];
 
@@ -103,7 +111,7 @@ static const char* configure(struct config* const config, const unsigned int arg
                 }
             );
             const struct duration duration = duration_from_moment(moment);
-            if (duration.msecs < min_duration.msecs) {
+            if (duration.nsecs < min_duration.nsecs) {
                 return format_str("timer: duration must be >= 00:01");
             }
 
@@ -113,6 +121,55 @@ static const char* configure(struct config* const config, const unsigned int arg
             continue;
         }
 
+        if (str_equals(arg, "--speed")) {
+            const char* const raw = read_arg(argv, &i);
+            if (raw == NULL) {
+                return config_err_no_value_specified("speed");
+            }
+
+            char* end = NULL;
+            const double speed = strtod(raw, &end);
+            if (end == raw || *end != '\0' || !isfinite(speed) || speed < min_speed || speed > max_speed) {
+                return format_str("speed: factor must be a number in %g-%g", min_speed, max_speed);
+            }
+
+            config->mode.value->speed = speed;
+
+            continue;
+        }
+
+        if (str_equals(arg, "--fps")) {
+            const char* const raw = read_arg(argv, &i);
+            if (raw == NULL) {
+                return config_err_no_value_specified("fps");
+            }
+
+            char* end = NULL;
+            const unsigned long fps = strtoul(raw, &end, 10);
+            if (end == raw || *end != '\0' || raw[0] == '-' || fps == 0 || fps > max_fps) {
+                return format_str("fps: rate must be an integer in 1-%u", max_fps);
+            }
+
+            config->mode.value->fps = (unsigned int)fps;
+
+            continue;
+        }
+
+        if (str_equals(arg, "--adaptive-fps")) {
+            config->mode.value->adaptive_fps = true;
+            continue;
+        }
+
+        if (str_equals(arg, "--diskless")) {
+#if PLATFORM == PLATFORM_LINUX
+            config->mode.value->diskless = true;
+            continue;
+#else
+            // Files in memory which the players can open by path are there only on Linux.
+            return format_str("diskless: not supported on this platform");
+#endif
+        }
+
         if (str_equals(arg, "--satori")) {
             config->mode.value->ornamental = false;
             continue;
@@ -147,9 +204,10 @@ static const char* configure(struct config* const config, const unsigned int arg
 static void run(enum mode_type type, struct mode* const mode)
 {
     struct sig_handler sig_handler = { 0 };
-    watch_sigs(&sig_handler, (unsigned int[]) { SIGINT, SIGTERM }, 2);
+    watch_sigs(&sig_handler, (unsigned int[]) { SIGINT, SIGTERM, SIGWINCH, SIGCHLD }, 4);
 
     struct mode_ctx ctx = {
+        .clock = wrap_clock_monotonic(),
         .sig_handler = &sig_handler,
     };
 
@@ -202,6 +260,41 @@ static int help(void)
         }
     );
 
+    print_arg_help(
+        "--speed N",
+        (const char*[]) {
+            "Run ccodoc N times as fast as real time, where N is in 0.01-10000.",
+            "Frames are skipped and sounds are thinned out where they cannot keep up.",
+            NULL,
+        }
+    );
+
+    print_arg_help(
+        "--fps N",
+        (const char*[]) {
+            "Draw N frames a second at most.",
+            "The default is 25, or with --satori the lowest rate that still shows every change of the arts.",
+            NULL,
+        }
+    );
+
+    print_arg_help(
+        "--adaptive-fps",
+        (const char*[]) {
+            "Lower the frame rate while drawing frames is slow, such as over a slow connection, and raise it back up to --fps once it is fast.",
+            NULL,
+        }
+    );
+
+    print_arg_help(
+        "--diskless",
+        (const char*[]) {
+            "Keep the sounds in memory instead of writing them to the cache directory.",
+            "This is for read-only home directories, and works only on Linux.",
+            NULL,
+        }
+    );
+
     print_arg_help("--help", (const char*[]) { "Print help.", NULL });
     print_arg_help("--version", (const char*[]) { "Print version.", NULL });
     print_arg_help("--license", (const char*[]) { "Print license.", NULL });
@@ -3,45 +3,82 @@
 #include "ccodoc.h"
 #include "platform.h"
 #include "renderer.h"
+#include "sound.h"
+#include "string.h"
 #include "time.h"
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "assets/sounds/sounds.h"
 
 typedef bool (*process_mode_t)(struct mode*, struct duration);
+typedef void (*render_mode_t)(struct mode*, struct duration);
+typedef struct duration (*schedule_mode_t)(const struct mode*);
+typedef void (*finish_mode_t)(const struct mode_ctx*, struct mode*);
+
+struct mode_impl {
+    process_mode_t process;
+    render_mode_t render;
+    schedule_mode_t schedule;
+    finish_mode_t finish;
+};
 
 static void init_ccodoc(struct mode* mode);
 static void deinit_ccodoc(struct mode* mode);
 
-static void init_renderer(struct mode* mode);
-static void deinit_renderer(struct mode* mode);
+static void init_frame_rate_mode(struct mode* mode);
+
+static void init_rendering(struct mode* mode);
+static void deinit_rendering(struct mode* mode);
 
 static void init_sound(struct mode* mode);
 static void deinit_sound(struct mode* mode);
 
-static void run_mode(const struct mode_ctx* ctx, struct mode* mode, process_mode_t process);
+static void run_mode(const struct mode_ctx* ctx, struct mode* mode, const struct mode_impl* impl);
 
 static bool process_wabi(struct mode*, struct duration delta);
 static bool process_sabi(struct mode*, struct duration delta);
 
+static void render_wabi(struct mode*, struct duration delta);
+static void render_sabi(struct mode*, struct duration delta);
+
+static struct duration schedule_wabi(const struct mode* mode);
+static struct duration schedule_sabi(const struct mode* mode);
+
+static void finish_sabi(const struct mode_ctx* ctx, struct mode* mode);
+
 static struct drawing_ctx make_drawing_ctx_center(const struct canvas* canvas);
 
-static void play_sound(const char* file);
+static void on_tsutsu_got_drip(struct mode* mode);
+static void on_tsutsu_bumped(struct mode* mode);
+static void play_pending_sounds(struct mode* mode, struct duration time);
+static void play_pending_sound(struct mode* mode, const char* file, bool* pending, struct duration* played_at, struct duration time);
+static void play_sound(struct mode* mode, const char* file);
+static void run_player(struct mode* mode, const char* file);
+static void start_remote_players(struct mode* mode);
+static void stop_remote_players(struct mode* mode);
+static struct remote_player* find_remote_player(struct mode* mode, const char* file);
 
 void init_mode(struct mode* const mode)
 {
-    init_renderer(mode);
+    if (mode->speed <= 0) {
+        mode->speed = 1;
+    }
+
+    init_rendering(mode);
     init_sound(mode);
 
     init_ccodoc(mode);
+
+    init_frame_rate_mode(mode);
 }
 
 void deinit_mode(struct mode* const mode)
 {
     deinit_ccodoc(mode);
-    deinit_renderer(mode);
+    deinit_rendering(mode);
     deinit_sound(mode);
 }
 
@@ -51,21 +88,21 @@ static void init_ccodoc(struct mode* const mode)
         .kakehi = {
             .release_water_amount = 1,
             .holding_water = {
-                .duration = { .msecs = 2200 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(2200) },
             },
             .releasing_water = {
-                .duration = { .msecs = 800 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(800) },
             },
         },
         .tsutsu = {
             .water_capacity = 10,
             .releasing_water = {
-                .duration = { .msecs = 1200 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(1200) },
             },
         },
         .hachi = {
             .releasing_water = {
-                .duration = { .msecs = 1000 },
+                .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
             },
         },
     };
@@ -74,23 +111,17 @@ static void init_ccodoc(struct mode* const mode)
         return;
     }
 
-    {
-        const char* file = mode->sound.tsutsu_drip;
-        if (file != NULL) {
-            mode->ccodoc.tsutsu.on_got_drip = (struct event) {
-                .listener = (void*)file,
-                .listen = (event_listener_t)play_sound,
-            };
-        }
+    if (mode->sound.tsutsu_drip != NULL) {
+        mode->ccodoc.tsutsu.on_got_drip = (struct event) {
+            .listener = mode,
+            .listen = (event_listener_t)on_tsutsu_got_drip,
+        };
     }
-    {
-        const char* file = mode->sound.tsutsu_bump;
-        if (file != NULL) {
-            mode->ccodoc.tsutsu.on_bumped = (struct event) {
-                .listener = (void*)file,
-                .listen = (event_listener_t)play_sound,
-            };
-        }
+    if (mode->sound.tsutsu_bump != NULL) {
+        mode->ccodoc.tsutsu.on_bumped = (struct event) {
+            .listener = mode,
+            .listen = (event_listener_t)on_tsutsu_bumped,
+        };
     }
 }
 
@@ -100,25 +131,53 @@ static void deinit_ccodoc(struct mode* const mode)
     mode->ccodoc.tsutsu.on_bumped = (struct event) { 0 };
 }
 
-static void init_renderer(struct mode* const mode)
+static void init_frame_rate_mode(struct mode* const mode)
 {
-    init_canvas_curses(&mode->rendering.canvas.delegate);
-    init_canvas_proxy(&mode->rendering.canvas.proxy, &mode->rendering.canvas.delegate);
+    // The ornaments move smoothly at the usual rate of animations,
+    // while satori shows each of the arts without them at least once, which needs the lowest rate.
+    static const unsigned int ornamental_fps = 25;
+
+    unsigned int fps = mode->fps;
+    if (fps == 0) {
+        fps = mode->ornamental ? ornamental_fps : fps_from_duration(get_ccodoc_min_art_duration(&mode->ccodoc));
+    }
+
+    init_frame_rate(&mode->frame_rate, fps, mode->adaptive_fps);
+}
+
+static void init_rendering(struct mode* const mode)
+{
+    struct canvas underlying = { 0 };
+
+    if (mode->headless) {
+        // Render to a buffer of the size of a usual terminal, which nobody sees.
+        init_canvas_buffer(&mode->rendering.canvas.buffer, (struct vec2d) { .x = 80, .y = 24 });
+        underlying = wrap_canvas_buffer(&mode->rendering.canvas.buffer);
+    } else if (mode->ornamental) {
+        // Skip curses without ornaments, where colors are never drawn,
+        // as drawing with ANSI escape sequences directly is cheaper both to start and to run.
+        init_canvas_curses(&mode->rendering.canvas.curses);
+        underlying = wrap_canvas_curses(&mode->rendering.canvas.curses);
+    } else {
+        init_canvas_ansi(&mode->rendering.canvas.ansi, STDOUT_FILENO);
+        underlying = wrap_canvas_ansi(&mode->rendering.canvas.ansi);
+    }
+
+    init_canvas_proxy(&mode->rendering.canvas.proxy, underlying);
 
     mode->rendering.canvas.value = wrap_canvas_proxy(&mode->rendering.canvas.proxy);
 
-    mode->rendering.renderer = (struct renderer) {
-        .canvas = &mode->rendering.canvas.value,
-        .ornamental = mode->ornamental,
-    };
+    init_renderer(&mode->rendering.renderer, &mode->rendering.canvas.value, mode->ornamental);
 }
 
-static void deinit_renderer(struct mode* const mode)
+static void deinit_rendering(struct mode* const mode)
 {
+    deinit_renderer(&mode->rendering.renderer);
     deinit_canvas(&mode->rendering.canvas.value);
 }
 
-static char* install_sound(const char* const name, const unsigned char* data, size_t len);
+static char* install_sound(struct mode* mode, const char* name, const char* hash, const unsigned char* data, size_t len);
+static char* install_sound_in_memory(struct mode* mode, const char* name, const unsigned char* data, size_t len);
 
 static void init_sound(struct mode* const mode)
 {
@@ -126,13 +185,29 @@ static void init_sound(struct mode* const mode)
         return;
     }
 
-    mode->sound.tsutsu_drip = install_sound("tsutsu_drip.mp3", sound_tsutsu_drip, sizeof(sound_tsutsu_drip));
-    mode->sound.tsutsu_bump = install_sound("tsutsu_bump.mp3", sound_tsutsu_bump, sizeof(sound_tsutsu_bump));
-    mode->sound.uguisu_call = install_sound("uguisu_call.mp3", sound_uguisu_call, sizeof(sound_uguisu_call));
+    mode->sound.tsutsu_drip = install_sound(mode, "tsutsu_drip.mp3", sound_tsutsu_drip_hash, sound_tsutsu_drip, sizeof(sound_tsutsu_drip));
+    mode->sound.tsutsu_bump = install_sound(mode, "tsutsu_bump.mp3", sound_tsutsu_bump_hash, sound_tsutsu_bump, sizeof(sound_tsutsu_bump));
+    mode->sound.uguisu_call = install_sound(mode, "uguisu_call.mp3", sound_uguisu_call_hash, sound_uguisu_call, sizeof(sound_uguisu_call));
+
+    if (mode->headless) {
+        return;
+    }
+
+    start_remote_players(mode);
+
+    const char* const err = init_sound_player(&mode->sound.player, mode, (play_sound_t)run_player);
+    if (err != NULL) {
+        // Discard the error as the player plays the sounds in place without the worker, which only costs some frames.
+        free((void*)err);
+    }
 }
 
 static void deinit_sound(struct mode* const mode)
 {
+    // Stop the worker first, which may still be playing the sounds.
+    deinit_sound_player(&mode->sound.player);
+    stop_remote_players(mode);
+
     if (mode->sound.tsutsu_drip != NULL) {
         free((void*)mode->sound.tsutsu_drip);
     }
@@ -144,98 +219,214 @@ static void deinit_sound(struct mode* const mode)
     if (mode->sound.uguisu_call != NULL) {
         free((void*)mode->sound.uguisu_call);
     }
+
+    for (unsigned int i = 0; i < mode->sound.mem_fds.len; i++) {
+        (void)close(mode->sound.mem_fds.values[i]);
+    }
+    mode->sound.mem_fds.len = 0;
 }
 
 void run_mode_wabi(const struct mode_ctx* const ctx, struct mode* const mode)
 {
-    run_mode(ctx, mode, process_wabi);
+    static const struct mode_impl impl = {
+        .process = process_wabi,
+        .render = render_wabi,
+        .schedule = schedule_wabi,
+    };
+
+    run_mode(ctx, mode, &impl);
 }
 
 void run_mode_sabi(const struct mode_ctx* const ctx, struct mode* const mode)
 {
-    run_mode(ctx, mode, process_sabi);
+    static const struct mode_impl impl = {
+        .process = process_sabi,
+        .render = render_sabi,
+        .schedule = schedule_sabi,
+        .finish = finish_sabi,
+    };
+
+    run_mode(ctx, mode, &impl);
 }
 
-static bool process_for(struct mode* mode, const process_mode_t process, struct duration min_delta, struct duration duration);
+static bool process_for(struct mode* mode, const struct mode_impl* impl, struct duration time, struct duration min_delta, struct duration duration);
+static struct duration get_next_delta(const struct mode* mode, const struct mode_impl* impl, struct duration min_delta);
+static bool wait_frame(const struct mode_ctx* ctx, struct mode* mode, const struct duration* deadline);
+static bool handle_sig(struct mode* mode, unsigned int sig);
 
-static void run_mode(const struct mode_ctx* const ctx, struct mode* const mode, const process_mode_t process)
+static void run_mode(const struct mode_ctx* const ctx, struct mode* const mode, const struct mode_impl* const impl)
 {
-    static const struct duration min_delta = { .msecs = 1000 / 25 };
-
-    struct duration last_time = get_monotonic_time();
+    struct duration last_time = get_clock_time(&ctx->clock);
+    schedule_frame(&mode->pacing, last_time);
 
     while (true) {
-        {
-            unsigned int sig = 0;
-            bool caught = false;
-            const char* const err = catch_sig(ctx->sig_handler, &sig, &caught);
-            if (err != NULL) {
-                // Discard the error as signal handling is less critical than ccodoc or the main functionality,
-                // and ccodoc works fine even without it at worst.
-                free((void*)err);
-            }
-            if (caught) {
-                return;
-            }
-        }
+        const struct duration min_delta = get_frame_time(&mode->frame_rate);
 
-        const struct duration time = get_monotonic_time();
+        const struct duration time = get_clock_time(&ctx->clock);
+        wake_up_frame(&mode->pacing, time, min_delta);
 
-        const struct duration delta = duration_diff(time, last_time);
+        const struct duration delta = scale_duration(duration_diff(time, last_time), mode->speed);
         last_time = time;
 
-        const bool continues = process_for(mode, process, min_delta, delta);
+        const bool continues = process_for(mode, impl, time, min_delta, delta);
         if (!continues) {
             break;
         }
 
-        const struct duration process_time = duration_diff(get_monotonic_time(), time);
+        // Sleep until the picture changes next, waking up on signals to handle them without delay.
+        // The deadline is absolute from the time the picture is of, so that neither the time spent processing
+        // nor interrupted sleeps push the frames back.
+        // Frames that take longer than this to process are not queued but skipped, as the next frame catches up with them.
+        const struct duration next_delta = scale_duration(get_next_delta(mode, impl, min_delta), 1 / mode->speed);
+        const struct duration deadline = { .nsecs = time.nsecs + next_delta.nsecs };
+        schedule_frame(&mode->pacing, deadline);
 
-        sleep_for(duration_diff(min_delta, process_time));
+        if (!wait_frame(ctx, mode, &deadline)) {
+            return;
+        }
     }
 
-    sigset_t sigs = { 0 };
-    sigemptyset(&sigs);
+    if (impl->finish != NULL) {
+        impl->finish(ctx, mode);
+    }
 
-    sigsuspend(&sigs);
+    if (ctx->sig_handler == NULL) {
+        return;
+    }
+
+    // Keep the last picture until asked to quit.
+    while (wait_frame(ctx, mode, NULL)) {
+        impl->render(mode, (struct duration) { 0 });
+    }
 }
 
+// wait_frame sleeps until the deadline, or until asked to quit without any deadline,
+// and returns whether to go on.
+// It wakes up on the signals caught on the way, returning right after handling the ones changing the picture or quitting.
+// The players started for the sounds exiting change nothing on the picture, which are reaped while waiting for the same deadline.
+static bool wait_frame(const struct mode_ctx* const ctx, struct mode* const mode, const struct duration* const deadline)
+{
+    // The signals are waited for in the monotonic time only.
+    if (ctx->sig_handler == NULL || ctx->clock.type != clock_monotonic) {
+        if (deadline != NULL) {
+            sleep_clock_until(&ctx->clock, *deadline);
+        }
+        return deadline != NULL;
+    }
+
+    while (true) {
+        unsigned int sig = 0;
+        bool caught = false;
+        const char* const err = wait_sig(ctx->sig_handler, deadline, &sig, &caught);
+        if (err != NULL) {
+            // Discard the error as signal handling is less critical than ccodoc or the main functionality,
+            // and ccodoc works fine even without it at worst.
+            free((void*)err);
+
+            if (deadline != NULL) {
+                sleep_clock_until(&ctx->clock, *deadline);
+            }
+            return deadline != NULL;
+        }
+        if (!caught) {
+            return true;
+        }
+
+        if (sig == SIGCHLD) {
+            reap_cmds();
+            continue;
+        }
+
+        return handle_sig(mode, sig);
+    }
+}
+
+static bool handle_sig(struct mode* const mode, const unsigned int sig)
+{
+    if (sig == SIGWINCH) {
+        fit_canvas(&mode->rendering.canvas.value);
+        return true;
+    }
+
+    return false;
+}
+
+// process_for advances the mode by the duration and renders the result at the time.
+// When the duration takes more than a step, for example after the process was stopped or the machine slept,
+// it catches up with the steps in between without rendering them, and plays each sound requested during them just once.
 static bool process_for(
-    struct mode* const mode, const process_mode_t process,
-    const struct duration min_delta, const struct duration duration
+    struct mode* const mode, const struct mode_impl* const impl,
+    const struct duration time, const struct duration min_delta, const struct duration duration
 )
 {
-    for (struct duration elapsed = { 0 }; elapsed.msecs < duration.msecs;) {
+    bool continues = true;
+    for (struct duration elapsed = { 0 }; continues && elapsed.nsecs < duration.nsecs;) {
         const struct duration delta = (struct duration) {
-            .msecs = MIN(min_delta.msecs, duration.msecs - elapsed.msecs),
+            .nsecs = MIN(get_next_delta(mode, impl, min_delta).nsecs, duration.nsecs - elapsed.nsecs),
         };
 
-        const bool continues = process(mode, delta);
-        if (!continues) {
-            return false;
+        continues = impl->process(mode, delta);
+
+        elapsed.nsecs += delta.nsecs;
+    }
+
+    // Render the frame with the time it took on the clock.
+    {
+        const struct duration start = mode->frame_rate.adaptive ? get_monotonic_time() : (struct duration) { 0 };
+
+        impl->render(mode, scale_duration(duration, 1 / mode->speed));
+
+        // The cost is measured in the wall time, which the frames take on the terminal whatever the clock is.
+        if (mode->frame_rate.adaptive) {
+            adapt_frame_rate(&mode->frame_rate, duration_diff(get_monotonic_time(), start));
         }
+    }
+
+    play_pending_sounds(mode, time);
 
-        elapsed.msecs += delta.msecs;
+    return continues;
+}
+
+// get_next_delta returns the time in the mode to process at once, during which the picture stays the same.
+// It is at least the frame time on the clock so that quick successive changes are drawn at the frame rate at most.
+static struct duration get_next_delta(const struct mode* const mode, const struct mode_impl* const impl, const struct duration min_delta)
+{
+    // Wake up once in a while even when nothing is scheduled to change, which bounds the timeout.
+    static const struct duration max_delta = { .nsecs = NSECS_FROM_MSECS(time_min) };
+
+    const struct duration min = scale_duration(min_delta, mode->speed);
+    const struct duration max = scale_duration(max_delta, mode->speed);
+
+    if (mode->debug) {
+        // The debug info changes every frame.
+        return min;
     }
 
-    return true;
+    const struct duration delta = impl->schedule(mode);
+
+    return (struct duration) {
+        .nsecs = CLAMP(min.nsecs, max.nsecs, delta.nsecs),
+    };
 }
 
 static bool process_wabi(struct mode* const mode, const struct duration delta)
 {
     tick_ccodoc(&mode->ccodoc, delta);
 
+    return true;
+}
+
+static void render_wabi(struct mode* const mode, const struct duration delta)
+{
     RENDER(&mode->rendering.renderer, {
         struct drawing_ctx ctx = make_drawing_ctx_center(&mode->rendering.canvas.value);
 
         render_ccodoc(&mode->rendering.renderer, &ctx, &mode->ccodoc);
 
         if (mode->debug) {
-            render_debug_info(&mode->rendering.renderer, delta, &mode->ccodoc, NULL);
+            render_debug_info(&mode->rendering.renderer, delta, &mode->pacing, get_dropped_sounds(&mode->sound.player), &mode->ccodoc, NULL);
         }
     });
-
-    return true;
 }
 
 static bool process_sabi(struct mode* const mode, const struct duration delta)
@@ -247,6 +438,24 @@ static bool process_sabi(struct mode* const mode, const struct duration delta)
     tick_ccodoc(ccodoc, delta);
     tick_timer(&mode->timer, delta);
 
+    // Stop the water flow now that the kakehi has released the last drop of water to fill up the tsutsu within the timer duration,
+    ccodoc->kakehi.disabled = get_remaining_time(&mode->timer).nsecs <= ccodoc->kakehi.releasing_water.duration.nsecs
+        && ccodoc->kakehi.state == releasing_water;
+
+    if (!timer_expires(&mode->timer)) {
+        return true;
+    }
+
+    // and wait for the tsutsu to release the water.
+    if (tsutsu_last_state != releasing_water || !action_has_finished(&ccodoc->tsutsu.releasing_water)) {
+        return true;
+    }
+
+    return false;
+}
+
+static void render_sabi(struct mode* const mode, const struct duration delta)
+{
     RENDER(&mode->rendering.renderer, {
         struct drawing_ctx ctx = make_drawing_ctx_center(&mode->rendering.canvas.value);
 
@@ -256,29 +465,41 @@ static bool process_sabi(struct mode* const mode, const struct duration delta)
         render_timer(&mode->rendering.renderer, &ctx, &mode->timer);
 
         if (mode->debug) {
-            render_debug_info(&mode->rendering.renderer, delta, &mode->ccodoc, &mode->timer);
+            render_debug_info(&mode->rendering.renderer, delta, &mode->pacing, get_dropped_sounds(&mode->sound.player), &mode->ccodoc, &mode->timer);
         }
     });
+}
 
-    // Stop the water flow now that the kakehi has released the last drop of water to fill up the tsutsu within the timer duration,
-    ccodoc->kakehi.disabled = get_remaining_time(&mode->timer).msecs <= ccodoc->kakehi.releasing_water.duration.msecs
-        && ccodoc->kakehi.state == releasing_water;
-
-    if (!timer_expires(&mode->timer)) {
-        return true;
+static void finish_sabi(const struct mode_ctx* const ctx, struct mode* const mode)
+{
+    if (mode->ornamental && mode->sound.uguisu_call != NULL) {
+        const struct duration time = get_clock_time(&ctx->clock);
+        sleep_clock_until(&ctx->clock, (struct duration) { .nsecs = time.nsecs + NSECS_FROM_MSECS(1750) });
+        play_sound(mode, mode->sound.uguisu_call);
     }
+}
 
-    // and wait for the tsutsu to release the water.
-    if (tsutsu_last_state != releasing_water || !action_has_finished(&ccodoc->tsutsu.releasing_water)) {
-        return true;
-    }
+static struct duration schedule_wabi(const struct mode* const mode)
+{
+    return get_ccodoc_redraw_delay(&mode->ccodoc);
+}
 
-    if (mode->ornamental && mode->sound.uguisu_call != NULL) {
-        sleep_for((struct duration) { .msecs = 1750 });
-        play_sound(mode->sound.uguisu_call);
+static struct duration schedule_sabi(const struct mode* const mode)
+{
+    const struct ccodoc* const ccodoc = &mode->ccodoc;
+
+    struct duration delay = get_ccodoc_redraw_delay(ccodoc);
+    delay.nsecs = MIN(delay.nsecs, get_timer_redraw_delay(&mode->timer).nsecs);
+
+    // The kakehi stops once the remaining time gets shorter than it takes to release water, which process_sabi checks.
+    if (!ccodoc->kakehi.disabled) {
+        const struct duration until_disabled = duration_diff(get_remaining_time(&mode->timer), ccodoc->kakehi.releasing_water.duration);
+        if (until_disabled.nsecs != 0) {
+            delay.nsecs = MIN(delay.nsecs, until_disabled.nsecs);
+        }
     }
 
-    return false;
+    return delay;
 }
 
 static struct drawing_ctx make_drawing_ctx_center(const struct canvas* const canvas)
@@ -301,8 +522,72 @@ static struct drawing_ctx make_drawing_ctx_center(const struct canvas* const can
     return ctx;
 }
 
-static void play_sound(const char* const name)
+static void on_tsutsu_got_drip(struct mode* const mode)
 {
+    mode->sound.pending.tsutsu_drip = true;
+}
+
+static void on_tsutsu_bumped(struct mode* const mode)
+{
+    mode->sound.pending.tsutsu_bump = true;
+}
+
+static void play_pending_sounds(struct mode* const mode, const struct duration time)
+{
+    play_pending_sound(mode, mode->sound.tsutsu_drip, &mode->sound.pending.tsutsu_drip, &mode->sound.played_at.tsutsu_drip, time);
+    play_pending_sound(mode, mode->sound.tsutsu_bump, &mode->sound.pending.tsutsu_bump, &mode->sound.played_at.tsutsu_bump, time);
+}
+
+// play_pending_sound plays the sound if pending, unless the last one of the kind played less than a sec ago on the clock,
+// which keeps fast runs from starting a player for every event.
+// The events at the real speed are farther apart than that.
+static void play_pending_sound(
+    struct mode* const mode, const char* const file,
+    bool* const pending, struct duration* const played_at, const struct duration time
+)
+{
+    static const struct duration min_interval = { .nsecs = NSECS_FROM_MSECS(time_sec) };
+
+    if (!*pending) {
+        return;
+    }
+
+    if (played_at->nsecs != 0 && duration_diff(time, *played_at).nsecs < min_interval.nsecs) {
+        return;
+    }
+
+    play_sound(mode, file);
+
+    *pending = false;
+    *played_at = time;
+}
+
+static void play_sound(struct mode* const mode, const char* const name)
+{
+    mode->sound.played.count++;
+    mode->sound.played.last = name;
+
+    if (mode->headless) {
+        return;
+    }
+
+    // Starting a player takes a fork, which is left to the worker so as not to hold the frames up.
+    queue_sound(&mode->sound.player, name);
+}
+
+static void run_player(struct mode* const mode, const char* const name)
+{
+    struct remote_player* const player = find_remote_player(mode, name);
+    if (player != NULL) {
+        const char* const err = load_remote_player(player, name);
+        if (err == NULL) {
+            return;
+        }
+
+        // Discard the error and start a player just for this sound instead.
+        free((void*)err);
+    }
+
 #if PLATFORM == PLATFORM_LINUX
     run_cmd("/usr/bin/mpg123", (const char*[]) { "mpg123", "--quiet", name, NULL });
 #elif PLATFORM == PLATFORM_MACOS
@@ -313,14 +598,86 @@ static void play_sound(const char* const name)
 #endif
 }
 
-static char* install_sound(const char* const name, const unsigned char* const data, const size_t len)
+// start_remote_players starts the players which load the sounds on request,
+// so that playing a sound costs a line written to the player rather than starting one and opening the audio device.
+// afplay on macOS has no such mode and is started for each sound.
+static void start_remote_players(struct mode* const mode)
 {
 #if PLATFORM == PLATFORM_LINUX
-    const char* const path = join_paths((const char*[]) { get_user_cache_dir(), "ccodoc/assets/sounds", name, NULL });
-#elif PLATFORM == PLATFORM_MACOS
-    const char* const path = join_paths((const char*[]) { get_user_cache_dir(), "ccodoc/assets/sounds", name, NULL });
+    static const char* const path = "/usr/bin/mpg123";
+    static const char* const args[] = { "mpg123", "--remote", NULL };
+
+    if (!has_file(path)) {
+        return;
+    }
+
+    struct remote_player* const players[] = {
+        &mode->sound.players.tsutsu_drip,
+        &mode->sound.players.tsutsu_bump,
+        &mode->sound.players.uguisu_call,
+    };
+    static const size_t players_len = sizeof(players) / sizeof(struct remote_player*);
+
+    for (size_t i = 0; i < players_len; i++) {
+        const char* const err = start_remote_player(players[i], path, args);
+        if (err != NULL) {
+            // Discard the error as the sound is played by a player started for it instead.
+            free((void*)err);
+            *players[i] = (struct remote_player) { 0 };
+        }
+    }
 #else
-    (void)name;
+    (void)mode;
+#endif
+}
+
+static void stop_remote_players(struct mode* const mode)
+{
+    stop_remote_player(&mode->sound.players.tsutsu_drip);
+    stop_remote_player(&mode->sound.players.tsutsu_bump);
+    stop_remote_player(&mode->sound.players.uguisu_call);
+}
+
+static struct remote_player* find_remote_player(struct mode* const mode, const char* const file)
+{
+    struct remote_player* player = NULL;
+
+    if (file == mode->sound.tsutsu_drip) {
+        player = &mode->sound.players.tsutsu_drip;
+    } else if (file == mode->sound.tsutsu_bump) {
+        player = &mode->sound.players.tsutsu_bump;
+    } else if (file == mode->sound.uguisu_call) {
+        player = &mode->sound.players.uguisu_call;
+    }
+
+    // The player is not there unless it has started.
+    return player != NULL && player->path != NULL ? player : NULL;
+}
+
+// install_sound installs the sound in the cache directory unless it is there already, and returns the path to it.
+// The installed copy is named after the hash of the content, so one stat comparing the size tells whether it is intact,
+// and a copy cut short, for example by an interrupted run, is installed again.
+static char* install_sound(
+    struct mode* const mode,
+    const char* const name, const char* const hash, const unsigned char* const data, const size_t len
+)
+{
+    // Nothing is played headless, which needs the names of the sounds only.
+    if (mode->headless) {
+        return copy_str(name);
+    }
+
+    // The sound is left silent rather than written to the disk, which is what the diskless run is to avoid.
+    if (mode->diskless) {
+        return install_sound_in_memory(mode, name, data, len);
+    }
+
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+    const char* const file = format_str("%s-%s", hash, name);
+    const char* const path = join_paths((const char*[]) { get_user_cache_dir(), "ccodoc/assets/sounds", file, NULL });
+    free((void*)file);
+#else
+    (void)hash;
     (void)data;
     (void)len;
     return NULL;
@@ -330,30 +687,53 @@ static char* install_sound(const char* const name, const unsigned char* const da
         return NULL;
     }
 
-    if (!has_file(path)) {
-        {
-            const char* const dir = get_dir(path);
-            const char* const err = make_dir(dir);
-            free((void*)dir);
-            if (err != NULL) {
-                return NULL;
-            }
+    {
+        size_t size = 0;
+        if (get_file_size(path, &size) && size == len) {
+            return (char*)path;
         }
+    }
 
-        FILE* file = fopen(path, "w");
-        if (file == NULL) {
+    {
+        const char* const dir = get_dir(path);
+        const char* const err = make_dir(dir);
+        free((void*)dir);
+        if (err != NULL) {
+            free((void*)err);
             free((void*)path);
             return NULL;
         }
+    }
 
-        const size_t n = fwrite(data, sizeof(unsigned char), len, file);
-        if (n < len) {
+    {
+        const char* const err = write_file_atomically(path, data, len);
+        if (err != NULL) {
+            free((void*)err);
             free((void*)path);
             return NULL;
         }
+    }
+
+    return (char*)path;
+}
 
-        (void)fclose(file);
+static char* install_sound_in_memory(struct mode* const mode, const char* const name, const unsigned char* const data, const size_t len)
+{
+    const unsigned int mem_fds_cap = sizeof(mode->sound.mem_fds.values) / sizeof(int);
+    if (mode->sound.mem_fds.len >= mem_fds_cap) {
+        return NULL;
+    }
+
+    int fd = -1;
+    const char* path = NULL;
+    const char* const err = make_mem_file(name, data, len, &fd, &path);
+    if (err != NULL) {
+        // Discard the error and leave the sound silent.
+        free((void*)err);
+        return NULL;
     }
 
+    mode->sound.mem_fds.values[mode->sound.mem_fds.len++] = fd;
+
     return (char*)path;
 }
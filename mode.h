@@ -3,9 +3,13 @@
 #include "ccodoc.h"
 #include "platform.h"
 #include "renderer.h"
+#include "sound.h"
 #include "time.h"
 
 struct mode_ctx {
+    // clock is the time the mode runs in, which headless runs can make virtual.
+    struct clock clock;
+    // sig_handler is optional, and is waited for in the monotonic time only.
     struct sig_handler* sig_handler;
 };
 
@@ -17,15 +21,31 @@ enum mode_type {
 struct mode {
     bool ornamental;
     bool debug;
+    // speed scales the time going on in the mode against the clock, which is 1 unless set.
+    double speed;
+    // headless runs the mode off the terminal and the speakers, rendering to a buffer and only counting the sounds.
+    bool headless;
+    // fps caps the frame rate, which defaults to the one of the mode unless set.
+    unsigned int fps;
+    // adaptive_fps lets the frame rate go down under the cap while presenting frames is slow, and back up once it gets fast.
+    bool adaptive_fps;
+    // diskless keeps the sounds in memory for the players instead of installing them in the cache directory,
+    // where it falls back to if the platform has no files in memory.
+    bool diskless;
 
     struct ccodoc ccodoc;
     struct timer timer;
 
+    struct frame_rate frame_rate;
+    struct frame_pacing pacing;
+
     struct {
         struct renderer renderer;
         struct {
             struct canvas value;
-            struct canvas_curses delegate;
+            struct canvas_buffer buffer;
+            struct canvas_curses curses;
+            struct canvas_ansi ansi;
             struct canvas_proxy proxy;
         } canvas;
     } rendering;
@@ -34,6 +54,36 @@ struct mode {
         const char* tsutsu_drip;
         const char* tsutsu_bump;
         const char* uguisu_call;
+
+        // mem_fds are the files in memory which the sounds are kept in when diskless.
+        struct {
+            int values[3];
+            unsigned int len;
+        } mem_fds;
+
+        struct sound_player player;
+        // players keep the players of the sounds running, one for each so that the sounds can overlap.
+        struct {
+            struct remote_player tsutsu_drip;
+            struct remote_player tsutsu_bump;
+            struct remote_player uguisu_call;
+        } players;
+
+        // pending holds the sounds requested while processing a frame, so that each of them is played at most once a frame,
+        // and held back further until the last one of the kind played long enough ago.
+        struct {
+            bool tsutsu_drip;
+            bool tsutsu_bump;
+        } pending;
+        struct {
+            struct duration tsutsu_drip;
+            struct duration tsutsu_bump;
+        } played_at;
+
+        struct {
+            unsigned long count;
+            const char* last;
+        } played;
     } sound;
 };
 
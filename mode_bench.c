@@ -0,0 +1,41 @@
+#include "mode.h"
+
+#include "bench.h"
+#include "time.h"
+#include <stdio.h>
+
+void bench_mode(void)
+{
+    printf("## main loop (sabi 08:00, headless)\n");
+
+    static const bool ornaments[] = { true, false };
+    static const size_t ornaments_len = sizeof(ornaments) / sizeof(bool);
+
+    for (size_t i = 0; i < ornaments_len; i++) {
+        struct clock_virtual clock = { 0 };
+        const struct mode_ctx ctx = {
+            .clock = wrap_clock_virtual(&clock),
+        };
+
+        struct mode mode = {
+            .ornamental = ornaments[i],
+            .headless = true,
+            .timer = {
+                .duration = duration_from_moment((struct moment) { .hours = 8 }),
+            },
+        };
+
+        init_mode(&mode);
+
+        const struct duration start = get_monotonic_time();
+        run_mode_sabi(&ctx, &mode);
+        const struct duration took = duration_diff(get_monotonic_time(), start);
+
+        printf("%s:\n", mode.ornamental ? "ornamental" : "satori");
+        printf("  frames: %lu\n", mode.pacing.frames);
+        printf("  took: %.2f msecs\n", (double)took.nsecs / (double)NSECS_FROM_MSECS(1));
+        printf("  per frame: %.2f usecs\n", (double)took.nsecs / 1000.0 / (double)mode.pacing.frames);
+
+        deinit_mode(&mode);
+    }
+}
@@ -0,0 +1,202 @@
+#include "mode.h"
+
+#include "math.h"
+#include "string.h"
+#include "test.h"
+#include "time.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+static int expect_sabi_ends(const char* file, int line, const struct clock_virtual* clock, const struct mode* mode, struct duration max_wait);
+#define EXPECT_SABI_ENDS(clock, mode, max_wait) EXPECT_PASS(expect_sabi_ends(__FILE__, __LINE__, clock, mode, max_wait))
+
+int test_mode(void)
+{
+    {
+        printf("## sabi 08:00 (headless)\n");
+
+        struct clock_virtual clock = { 0 };
+        const struct mode_ctx ctx = {
+            .clock = wrap_clock_virtual(&clock),
+        };
+
+        struct mode mode = {
+            .ornamental = true,
+            .headless = true,
+            .timer = {
+                .duration = duration_from_moment((struct moment) { .hours = 8 }),
+            },
+        };
+
+        init_mode(&mode);
+        run_mode_sabi(&ctx, &mode);
+
+        // The session lasts until the tsutsu releases the water after the timer expires, taking a frame at most to notice.
+        const int result = expect_sabi_ends(__FILE__, __LINE__, &clock, &mode, duration_from_msecs(1200 + 1000 / 25));
+
+        deinit_mode(&mode);
+
+        if (result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        printf("## sabi 08:00 with sub-msec jitter (headless)\n");
+
+        // The clock oversleeps every frame by up to a msec, so that the deltas between the frames have sub-msec parts.
+        struct clock_virtual clock = {
+            .jitter = { .nsecs = NSECS_FROM_MSECS(1) - 1 },
+        };
+        const struct mode_ctx ctx = {
+            .clock = wrap_clock_virtual(&clock),
+        };
+
+        struct mode mode = {
+            .ornamental = true,
+            .headless = true,
+            .timer = {
+                .duration = duration_from_moment((struct moment) { .hours = 8 }),
+            },
+        };
+
+        init_mode(&mode);
+        run_mode_sabi(&ctx, &mode);
+
+        // The last frame and the wait for the uguisu may each oversleep by up to a msec.
+        int result = expect_sabi_ends(__FILE__, __LINE__, &clock, &mode, duration_from_msecs(1200 + 1000 / 25 + 2));
+
+        if (result == EXIT_SUCCESS) {
+            // The timer has gone on by the deltas between the frames until the session ended, the uguisu wait before the end of the clock,
+            // which adds up to the time on the clock without losing the sub-msec parts.
+            const uint64_t session_time = clock.time.nsecs - NSECS_FROM_MSECS(1750);
+            const uint64_t elapsed = mode.timer.ticker.elapsed.nsecs;
+            const uint64_t drift = MAX(session_time, elapsed) - MIN(session_time, elapsed);
+
+            char actual[1 << 6] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%" PRIu64 " nsecs", drift);
+
+            const bool passes = drift < NSECS_FROM_MSECS(1);
+            report_status(__FILE__, __LINE__, passes, "keeps the timer within a msec of the clock", actual, "< 1000000 nsecs");
+            result = passes ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        deinit_mode(&mode);
+
+        if (result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        printf("## sabi 08:00 at 100x (headless)\n");
+
+        struct clock_virtual clock = { 0 };
+        const struct mode_ctx ctx = {
+            .clock = wrap_clock_virtual(&clock),
+        };
+
+        struct mode mode = {
+            .ornamental = true,
+            .headless = true,
+            .speed = 100,
+            .timer = {
+                .duration = duration_from_moment((struct moment) { .hours = 8 }),
+            },
+        };
+
+        init_mode(&mode);
+        run_mode_sabi(&ctx, &mode);
+
+        int result = expect_sabi_ends(__FILE__, __LINE__, &clock, &mode, duration_from_msecs(1200 / 100 + 1000 / 25));
+
+        if (result == EXIT_SUCCESS) {
+            // Each kind of the sounds of the tsutsu plays once a sec at most, and the uguisu calls once.
+            const uint64_t max = 2 * (msecs_from_duration(clock.time) / time_sec + 1) + 1;
+
+            char actual[1 << 6] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%lu sounds", mode.sound.played.count);
+
+            char expected[1 << 6] = { 0 };
+            (void)snprintf(expected, sizeof(expected), "<= %" PRIu64 " sounds", max);
+
+            const bool passes = mode.sound.played.count <= max;
+            report_status(__FILE__, __LINE__, passes, "throttles sounds", actual, expected);
+            result = passes ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        deinit_mode(&mode);
+
+        if (result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        printf("## satori\n");
+
+        struct mode mode = {
+            .headless = true,
+        };
+
+        init_mode(&mode);
+
+        // The hachi stays kyu for the shortest, 300 msecs, which a frame every 250 msecs does not miss.
+        char actual[1 << 5] = { 0 };
+        (void)snprintf(actual, sizeof(actual), "%u fps", mode.frame_rate.max);
+
+        const bool passes = mode.frame_rate.max == 4;
+        report_status(__FILE__, __LINE__, passes, "defaults to the lowest rate showing every art", actual, "4 fps");
+
+        deinit_mode(&mode);
+
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// expect_sabi_ends expects the session to have ended on the clock after the timer, waiting no longer than the max wait,
+// and the uguisu to have called at last.
+static int expect_sabi_ends(
+    const char* const file, const int line,
+    const struct clock_virtual* const clock, const struct mode* const mode, const struct duration max_wait
+)
+{
+    // The uguisu calls a while after the session.
+    static const uint64_t uguisu_wait = 1750;
+
+    {
+        const struct duration timer_time = scale_duration(mode->timer.duration, 1 / mode->speed);
+        const uint64_t min = msecs_from_duration(timer_time) + uguisu_wait;
+        const uint64_t max = min + msecs_from_duration(max_wait);
+
+        const uint64_t time = msecs_from_duration(clock->time);
+
+        char actual[1 << 6] = { 0 };
+        (void)snprintf(actual, sizeof(actual), "%" PRIu64 " msecs", time);
+
+        char expected[1 << 6] = { 0 };
+        (void)snprintf(expected, sizeof(expected), "%" PRIu64 "-%" PRIu64 " msecs", min, max);
+
+        const bool passes = timer_expires(&mode->timer) && time >= min && time <= max;
+        report_status(file, line, passes, "ends after the timer", actual, expected);
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        const char* const actual = mode->sound.played.last != NULL ? mode->sound.played.last : "none";
+
+        const bool passes = str_equals(actual, "uguisu_call.mp3");
+        report_status_str(file, line, passes, "calls uguisu at last", actual, "uguisu_call.mp3");
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
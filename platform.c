@@ -3,20 +3,32 @@
 #include "platform.h"
 
 #include "string.h"
+#include "time.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <libgen.h>
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#if PLATFORM == PLATFORM_LINUX
+#include <sys/mman.h>
+#endif
+#include <sys/socket.h>
+#if PLATFORM == PLATFORM_LINUX
+#include <sys/signalfd.h>
+#endif
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
+extern char** environ;
+
 const char* get_user_home_dir(void)
 {
 #if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
@@ -142,46 +154,353 @@ bool has_file(const char* const path)
     return stat(path, &s) == 0;
 }
 
+// get_file_size returns whether the file exists, reporting its size if so.
+bool get_file_size(const char* const path, size_t* const size)
+{
+    struct stat s = { 0 };
+    if (stat(path, &s) != 0) {
+        return false;
+    }
+
+    *size = (size_t)s.st_size;
+    return true;
+}
+
+// write_file_atomically writes the data to a temporary file next to the path and renames it to the path,
+// so that the path has either the whole data or what it had before, even if the process is killed on the way.
+const char* write_file_atomically(const char* const path, const unsigned char* const data, const size_t len)
+{
+    const char* const tmp_path = format_str("%s.%d.tmp", path, (int)getpid());
+
+    errno = 0;
+    const int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        const char* const err = format_str("failed to open %s: %d", tmp_path, errno);
+        free((void*)tmp_path);
+        return err;
+    }
+
+    const char* err = NULL;
+
+    for (size_t written = 0; written < len;) {
+        errno = 0;
+        const ssize_t n = write(fd, data + written, len - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            err = format_str("failed to write %s: %d", tmp_path, errno);
+            break;
+        }
+
+        written += (size_t)n;
+    }
+
+    // Flush the data before the rename makes it visible at the path.
+    if (err == NULL && fsync(fd) != 0) {
+        err = format_str("failed to sync %s: %d", tmp_path, errno);
+    }
+
+    if (close(fd) != 0 && err == NULL) {
+        err = format_str("failed to close %s: %d", tmp_path, errno);
+    }
+
+    if (err == NULL && rename(tmp_path, path) != 0) {
+        err = format_str("failed to rename %s: %d", tmp_path, errno);
+    }
+
+    if (err != NULL) {
+        (void)unlink(tmp_path);
+    }
+
+    free((void*)tmp_path);
+
+    return err;
+}
+
+// make_mem_file puts the data in a sealed file in memory, which has nothing to do with any filesystem,
+// and returns its fd along with the path the commands started afterwards open it with.
+// The fd is left open across exec for the commands, which open it through their own /proc/self/fd.
+const char* make_mem_file(const char* const name, const unsigned char* const data, const size_t len, int* const fd, const char** const path)
+{
+#if PLATFORM == PLATFORM_LINUX
+    errno = 0;
+    const int fd2 = memfd_create(name, MFD_ALLOW_SEALING);
+    if (fd2 < 0) {
+        return format_str("failed to create memfd: %d", errno);
+    }
+
+    for (size_t written = 0; written < len;) {
+        errno = 0;
+        const ssize_t n = write(fd2, data + written, len - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const int err = errno;
+            (void)close(fd2);
+            return format_str("failed to write memfd: %d", err);
+        }
+
+        written += (size_t)n;
+    }
+
+    {
+        // Keep the players from changing the data under each other.
+        errno = 0;
+        const int status = fcntl(fd2, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+        if (status != 0) {
+            const int err = errno;
+            (void)close(fd2);
+            return format_str("failed to seal memfd: %d", err);
+        }
+    }
+
+    *fd = fd2;
+    *path = format_str("/proc/self/fd/%d", fd2);
+
+    return NULL;
+#else
+    (void)name;
+    (void)data;
+    (void)len;
+    (void)fd;
+    (void)path;
+    return format_str("unsupported platform");
+#endif
+}
+
+static const char* spawn(const char* path, const char* const* args, const posix_spawn_file_actions_t* actions, int* pid);
+
+// run_cmd starts the command in the background, discarding any error.
 void run_cmd(const char* const path, const char* const* const args)
+{
+    int pid = 0;
+    const char* const err = spawn_cmd(path, args, &pid);
+    if (err != NULL) {
+        free((void*)err);
+    }
+}
+
+// spawn_cmd starts the command and returns right away without waiting for it, which reap_cmds reaps once it exits.
+const char* spawn_cmd(const char* const path, const char* const* const args, int* const pid)
+{
+    return spawn(path, args, NULL, pid);
+}
+
+// reap_cmds reaps all the commands which have exited, which is to be called on SIGCHLD.
+void reap_cmds(void)
 {
 #if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
-    const int child_pid = fork();
-    if (child_pid == -1) {
-        return;
+    int status = 0;
+    while (waitpid(-1, &status, WNOHANG) > 0) { }
+#endif
+}
+
+// start_cmd_pipe starts the command with its standard input connected to the cmd,
+// and its standard output and error discarded.
+// The input is a socket, which reports the command gone as an error instead of SIGPIPE,
+// and as a hangup to cmd_pipe_runs whoever reaps the command.
+const char* start_cmd_pipe(struct cmd_pipe* const cmd, const char* const path, const char* const* const args)
+{
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+    int fds[2] = { 0 };
+    {
+        errno = 0;
+        const int status = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        if (status != 0) {
+            return format_str("failed to init socket pair: %d", errno);
+        }
     }
 
-    if (child_pid == 0) {
-        const int gchild_pid = fork();
-        if (gchild_pid == -1) {
-            exit(1);
-            return;
+    {
+        // Keep both ends from leaking into other commands, which the duplicate onto the standard input does not inherit.
+        errno = 0;
+        const bool configured = fcntl(fds[0], F_SETFD, FD_CLOEXEC) == 0 && fcntl(fds[1], F_SETFD, FD_CLOEXEC) == 0;
+        if (!configured) {
+            const int err = errno;
+            (void)close(fds[0]);
+            (void)close(fds[1]);
+            return format_str("failed to set close-on-exec: %d", err);
         }
+    }
 
-        if (gchild_pid == 0) {
-            execv(path, (char* const*)args);
+#if PLATFORM == PLATFORM_MACOS
+    {
+        const int on = 1;
+        (void)setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+#endif
 
-            exit(1);
-            return;
-        }
+    posix_spawn_file_actions_t actions = { 0 };
+    (void)posix_spawn_file_actions_init(&actions);
+    (void)posix_spawn_file_actions_adddup2(&actions, fds[1], STDIN_FILENO);
+    (void)posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    (void)posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    int pid = 0;
+    const char* const err = spawn(path, args, &actions, &pid);
 
-        exit(0);
+    (void)posix_spawn_file_actions_destroy(&actions);
+    (void)close(fds[1]);
+
+    if (err != NULL) {
+        (void)close(fds[0]);
+        return err;
+    }
+
+    *cmd = (struct cmd_pipe) {
+        .pid = pid,
+        .input = fds[0],
+    };
+
+    return NULL;
+#else
+    (void)cmd;
+    (void)path;
+    (void)args;
+    return format_str("unsupported platform");
+#endif
+}
+
+// stop_cmd_pipe closes the input of the command and terminates it.
+void stop_cmd_pipe(struct cmd_pipe* const cmd)
+{
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+    if (cmd->pid <= 0) {
         return;
     }
 
-    int status = 0;
-    waitpid(child_pid, &status, 0);
+    // The pid may have been reaped and reused by others once the command exited.
+    if (cmd_pipe_runs(cmd)) {
+        (void)kill(cmd->pid, SIGTERM);
+
+        // The command may also be reaped on SIGCHLD before this, which is fine.
+        int status = 0;
+        (void)waitpid(cmd->pid, &status, 0);
+
+        (void)close(cmd->input);
+    }
+
+    *cmd = (struct cmd_pipe) { 0 };
+#else
+    (void)cmd;
+#endif
+}
+
+// cmd_pipe_runs returns whether the command is still running, closing its input if it has exited.
+// The command counts as exited once its end of the input hangs up, whether it has been reaped or not.
+bool cmd_pipe_runs(struct cmd_pipe* const cmd)
+{
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+    if (cmd->pid <= 0) {
+        return false;
+    }
+
+    // The command never writes to its input, which is readable only at the end.
+    struct pollfd fds[] = {
+        { .fd = cmd->input, .events = POLLIN },
+    };
+    int n = 0;
+    do {
+        errno = 0;
+        n = poll(fds, sizeof(fds) / sizeof(struct pollfd), 0);
+    } while (n < 0 && errno == EINTR);
+
+    // The command is not known to have exited unless poll says so.
+    if (n <= 0 || (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+        return true;
+    }
+
+    (void)close(cmd->input);
+    *cmd = (struct cmd_pipe) { 0 };
+
+    return false;
+#else
+    (void)cmd;
+    return false;
+#endif
+}
+
+const char* write_cmd_pipe(const struct cmd_pipe* const cmd, const char* const s)
+{
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+#if PLATFORM == PLATFORM_LINUX
+    static const int flags = MSG_NOSIGNAL;
+#else
+    static const int flags = 0;
+#endif
+
+    const size_t len = strlen(s);
+    for (size_t written = 0; written < len;) {
+        errno = 0;
+        const ssize_t n = send(cmd->input, s + written, len - written, flags);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return format_str("%d", errno);
+        }
+
+        written += (size_t)n;
+    }
+
+    return NULL;
+#else
+    (void)cmd;
+    (void)s;
+    return format_str("unsupported platform");
+#endif
+}
+
+// spawn starts the command with no signals blocked, which the calling thread may block,
+// without copying the memory of the calling process as fork does.
+static const char* spawn(const char* const path, const char* const* const args, const posix_spawn_file_actions_t* const actions, int* const pid)
+{
+#if PLATFORM == PLATFORM_LINUX || PLATFORM == PLATFORM_MACOS
+    posix_spawnattr_t attr = { 0 };
+    (void)posix_spawnattr_init(&attr);
+
+    sigset_t sigs = { 0 };
+    (void)sigemptyset(&sigs);
+    (void)posix_spawnattr_setsigmask(&attr, &sigs);
+    (void)posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    pid_t pid2 = 0;
+    const int status = posix_spawn(&pid2, path, actions, &attr, (char* const*)args, environ);
+
+    (void)posix_spawnattr_destroy(&attr);
+
+    if (status != 0) {
+        return format_str("failed to spawn %s: %d", path, status);
+    }
+
+    *pid = pid2;
+
+    return NULL;
+#else
+    (void)path;
+    (void)args;
+    (void)actions;
+    (void)pid;
+    return format_str("unsupported platform");
 #endif
 }
 
 static const char* init_sig_set(sigset_t* sig_set, unsigned int* sigs, size_t len);
+#if PLATFORM != PLATFORM_LINUX
 static bool watches_sig(const struct sig_handler* const handler, unsigned int sig);
 static void* wait_sigs(const struct sig_handler* const handler);
+static const char* write_sig(const struct sig_handler* const handler, const unsigned int* const sig);
+#endif
 
 static const char* read_sig(const struct sig_handler* const handler, unsigned int* const sig);
-static const char* write_sig(const struct sig_handler* const handler, const unsigned int* const sig);
-static int sig_pipe_read(const struct sig_handler* handler);
-static int sig_pipe_write(const struct sig_handler* handler);
+static const char* poll_sig(const struct sig_handler* handler, const struct duration* deadline, bool* ready);
 
+#if PLATFORM != PLATFORM_LINUX
 static int init_pipe(int* const dst)
 {
 #if PLATFORM != PLATFORM_MACOS
@@ -209,20 +528,15 @@ static int init_pipe(int* const dst)
     return EXIT_SUCCESS;
 #endif
 }
+#endif
 
+// watch_sigs starts to catch the signals, which wait_sig reports.
+// On Linux, the signals are read from a signalfd, which wait_sig polls without any thread in between.
 const char* watch_sigs(struct sig_handler* const handler, unsigned int* const sigs, const size_t len)
 {
     handler->sigs.values = sigs;
     handler->sigs.len = len;
 
-    {
-        errno = 0;
-        const int status = init_pipe(handler->pipe);
-        if (status != 0) {
-            return format_str("failed to init pipe: %d", errno);
-        }
-    }
-
     sigset_t sig_set = { 0 };
     {
         const char* const err = init_sig_set(&sig_set, sigs, len);
@@ -233,6 +547,30 @@ const char* watch_sigs(struct sig_handler* const handler, unsigned int* const si
         }
     }
 
+#if PLATFORM == PLATFORM_LINUX
+    {
+        errno = 0;
+        const int fd = signalfd(-1, &sig_set, SFD_CLOEXEC | SFD_NONBLOCK);
+        if (fd < 0) {
+            return format_str("failed to init signalfd: %d", errno);
+        }
+
+        handler->fd = fd;
+    }
+#else
+    {
+        int pipe[2] = { 0 };
+
+        errno = 0;
+        const int status = init_pipe(pipe);
+        if (status != 0) {
+            return format_str("failed to init pipe: %d", errno);
+        }
+
+        handler->fd = pipe[0];
+        handler->pipe_write = pipe[1];
+    }
+
     pthread_t thread = { 0 };
     {
         errno = 0;
@@ -248,55 +586,81 @@ const char* watch_sigs(struct sig_handler* const handler, unsigned int* const si
             return format_str("failed to detach signal thread: %d", errno);
         }
     }
+#endif
 
     return NULL;
 }
 
-const char* catch_sig(const struct sig_handler* const handler, unsigned int* const sig, bool* const caught)
+// wait_sig blocks until a signal is caught or the monotonic time reaches the deadline, if any,
+// in a single poll that wakes up only for either of them.
+const char* wait_sig(const struct sig_handler* const handler, const struct duration* const deadline, unsigned int* const sig, bool* const caught)
 {
-    fd_set fds = { 0 };
-    FD_ZERO(&fds);
+    bool ready = false;
+    {
+        const char* const err = poll_sig(handler, deadline, &ready);
+        if (err != NULL) {
+            const char* const err2 = format_str("failed to poll signals: %s", err);
+            free((void*)err);
+            return err2;
+        }
+    }
 
-    const int pipe = sig_pipe_read(handler);
-    FD_SET(pipe, &fds);
+    if (!ready) {
+        *caught = false;
+        return NULL;
+    }
 
-    while (true) {
-        {
-            fd_set fds_read = fds;
+    unsigned int sig2 = 0;
+    {
+        const char* const err = read_sig(handler, &sig2);
+        if (err != NULL) {
+            const char* const err2 = format_str("failed to read signal: %s", err);
+            free((void*)err);
+            return err2;
+        }
+    }
 
-            errno = 0;
-            const struct timespec timeout = { 0 };
-            const int n = pselect(pipe + 1, &fds_read, NULL, NULL, &timeout, NULL);
-            if (n < 0) {
-                if (errno == EINTR || errno == EAGAIN) {
-                    continue;
-                }
+    *sig = sig2;
+    *caught = sig2 != 0;
 
-                return format_str("failed to select signal pipe: %d", errno);
-            }
+    return NULL;
+}
 
-            if (n == 0 || !FD_ISSET(pipe, &fds_read)) {
-                *caught = false;
-                return NULL;
-            }
+static const char* poll_sig(const struct sig_handler* const handler, const struct duration* const deadline, bool* const ready)
+{
+    while (true) {
+        // Measure the timeout against the deadline on every try, so that retries do not push the deadline back.
+        struct timespec time = { 0 };
+        if (deadline != NULL) {
+            const struct duration timeout = duration_diff(*deadline, get_monotonic_time());
+            time.tv_sec = (time_t)(timeout.nsecs / NSECS_FROM_MSECS(time_sec));
+            time.tv_nsec = (long)(timeout.nsecs % NSECS_FROM_MSECS(time_sec));
         }
 
-        unsigned int sig2 = 0;
-        {
-            const char* const err = read_sig(handler, &sig2);
-            if (err != NULL) {
-                const char* const err2 = format_str("failed to read signal: %s", err);
-                free((void*)err);
-                return err2;
+        errno = 0;
+#if PLATFORM == PLATFORM_LINUX
+        struct pollfd fds[] = {
+            { .fd = handler->fd, .events = POLLIN },
+        };
+        const int n = ppoll(fds, sizeof(fds) / sizeof(struct pollfd), deadline != NULL ? &time : NULL, NULL);
+#else
+        fd_set fds = { 0 };
+        FD_ZERO(&fds);
+        FD_SET(handler->fd, &fds);
+
+        const int n = pselect(handler->fd + 1, &fds, NULL, NULL, deadline != NULL ? &time : NULL, NULL);
+#endif
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
             }
+
+            return format_str("%d", errno);
         }
 
-        *sig = sig2;
-        *caught = true;
-        break;
+        *ready = n > 0;
+        return NULL;
     }
-
-    return NULL;
 }
 
 static const char* init_sig_set(sigset_t* const sig_set, unsigned int* const sigs, const size_t len)
@@ -328,6 +692,32 @@ static const char* init_sig_set(sigset_t* const sig_set, unsigned int* const sig
     return NULL;
 }
 
+#if PLATFORM == PLATFORM_LINUX
+static const char* read_sig(const struct sig_handler* const handler, unsigned int* const sig)
+{
+    struct signalfd_siginfo info = { 0 };
+
+    while (true) {
+        errno = 0;
+        const ssize_t n = read(handler->fd, &info, sizeof(info));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                // Another reader took the signal first.
+                *sig = 0;
+                return NULL;
+            }
+
+            return format_str("%d", errno);
+        }
+
+        *sig = info.ssi_signo;
+        return NULL;
+    }
+}
+#else
 static bool watches_sig(const struct sig_handler* const handler, const unsigned int sig)
 {
     for (size_t i = 0; i < handler->sigs.len; i++) {
@@ -368,7 +758,7 @@ static const char* read_sig(const struct sig_handler* const handler, unsigned in
     static const size_t len = sizeof(unsigned int);
     unsigned int n_read = 0;
 
-    const int pipe = sig_pipe_read(handler);
+    const int pipe = handler->fd;
 
     while (n_read < len) {
         errno = 0;
@@ -395,7 +785,7 @@ static const char* write_sig(const struct sig_handler* const handler, const unsi
     static const size_t len = sizeof(unsigned int);
     unsigned int n_written = 0;
 
-    const int pipe = sig_pipe_write(handler);
+    const int pipe = handler->pipe_write;
 
     while (n_written < len) {
         errno = 0;
@@ -416,13 +806,4 @@ static const char* write_sig(const struct sig_handler* const handler, const unsi
 
     return NULL;
 }
-
-static int sig_pipe_read(const struct sig_handler* handler)
-{
-    return handler->pipe[0];
-}
-
-static int sig_pipe_write(const struct sig_handler* handler)
-{
-    return handler->pipe[1];
-}
+#endif
@@ -7,8 +7,19 @@
 #define PLATFORM_LINUX 1
 #define PLATFORM_MACOS 2
 
+struct duration;
+
+// cmd_pipe is a command running in the background, which reads its standard input from the parent.
+struct cmd_pipe {
+    int pid;
+    int input;
+};
+
 struct sig_handler {
-    int pipe[2];
+    // fd is read for the caught signals, which is a signalfd on Linux,
+    // and the read end of the pipe that a thread writes the signals to elsewhere.
+    int fd;
+    int pipe_write;
 
     struct {
         unsigned int* values;
@@ -24,8 +35,18 @@ extern const char* make_dir(const char* name);
 extern const char* join_paths(const char* const* paths);
 
 extern bool has_file(const char* path);
+extern bool get_file_size(const char* path, size_t* size);
+extern const char* write_file_atomically(const char* path, const unsigned char* data, size_t len);
+extern const char* make_mem_file(const char* name, const unsigned char* data, size_t len, int* fd, const char** path);
 
 extern void run_cmd(const char* path, const char* const* args);
+extern const char* spawn_cmd(const char* path, const char* const* args, int* pid);
+extern void reap_cmds(void);
+
+extern const char* start_cmd_pipe(struct cmd_pipe* cmd, const char* path, const char* const* args);
+extern void stop_cmd_pipe(struct cmd_pipe* cmd);
+extern bool cmd_pipe_runs(struct cmd_pipe* cmd);
+extern const char* write_cmd_pipe(const struct cmd_pipe* cmd, const char* s);
 
 extern const char* watch_sigs(struct sig_handler* handler, unsigned int* sigs, size_t len);
-extern const char* catch_sig(const struct sig_handler* handler, unsigned int* sig, bool* caught);
+extern const char* wait_sig(const struct sig_handler* handler, const struct duration* deadline, unsigned int* sig, bool* caught);
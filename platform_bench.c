@@ -0,0 +1,97 @@
+#include "platform.h"
+
+#include "bench.h"
+#include "time.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef void (*spawn_true_t)(void);
+
+static struct duration measure_spawn_latency(spawn_true_t spawn_true, unsigned int times);
+static void spawn_true_forking_twice(void);
+static void spawn_true_posix_spawn(void);
+
+void bench_platform(void)
+{
+    printf("## spawn latency (/bin/true)\n");
+
+    static const unsigned int times = 200;
+
+    // The cost of fork grows with the memory of the calling process, which the larger heap shows.
+    static const size_t heap_sizes[] = { 0, (size_t)1 << 27 };
+    static const size_t heap_sizes_len = sizeof(heap_sizes) / sizeof(size_t);
+
+    for (size_t i = 0; i < heap_sizes_len; i++) {
+        const size_t heap_size = heap_sizes[i];
+
+        char* const heap = heap_size != 0 ? malloc(heap_size) : NULL;
+        if (heap != NULL) {
+            // Touch every page so that they are mapped.
+            memset(heap, 1, heap_size);
+        }
+
+        const struct duration forking_twice = measure_spawn_latency(spawn_true_forking_twice, times);
+        const struct duration posix_spawn = measure_spawn_latency(spawn_true_posix_spawn, times);
+
+        printf("heap: %zu MiB\n", heap_size >> 20);
+        printf("  fork twice and wait: %.2f usecs\n", (double)forking_twice.nsecs / 1000.0);
+        printf("  posix_spawn: %.2f usecs\n", (double)posix_spawn.nsecs / 1000.0);
+
+        free(heap);
+    }
+}
+
+// measure_spawn_latency returns the average time the caller is blocked for to spawn the command.
+static struct duration measure_spawn_latency(const spawn_true_t spawn_true, const unsigned int times)
+{
+    struct duration took = { 0 };
+
+    for (unsigned int i = 0; i < times; i++) {
+        const struct duration start = get_monotonic_time();
+        spawn_true();
+        took.nsecs += duration_diff(get_monotonic_time(), start).nsecs;
+
+        // Reap the command out of the measurement, which ccodoc does on SIGCHLD.
+        reap_cmds();
+    }
+
+    // Reap the rest of the commands, which may have been still running.
+    int status = 0;
+    while (wait(&status) > 0) { }
+
+    return (struct duration) { .nsecs = took.nsecs / times };
+}
+
+// spawn_true_forking_twice spawns the command as run_cmd did before posix_spawn,
+// forking twice so that the command is reparented and waiting for the middle process.
+static void spawn_true_forking_twice(void)
+{
+    const int child_pid = fork();
+    if (child_pid == -1) {
+        return;
+    }
+
+    if (child_pid == 0) {
+        const int gchild_pid = fork();
+        if (gchild_pid == -1) {
+            _exit(1);
+        }
+
+        if (gchild_pid == 0) {
+            execv("/bin/true", (char* const[]) { "true", NULL });
+            _exit(1);
+        }
+
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child_pid, &status, 0);
+}
+
+static void spawn_true_posix_spawn(void)
+{
+    run_cmd("/bin/true", (const char*[]) { "true", NULL });
+}
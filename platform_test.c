@@ -2,7 +2,9 @@
 
 #include "string.h"
 #include "test.h"
+#include <dirent.h>
 #include <stdio.h>
+#include <unistd.h>
 
 static int expect_join_paths(const char* file, int line, const char* const* paths, const char* expected);
 #define EXPECT_JOIN_PATHS(paths, expected) EXPECT_PASS(expect_join_paths(__FILE__, __LINE__, paths, expected))
@@ -21,6 +23,138 @@ int test_platform(void)
         EXPECT_JOIN_PATHS(((const char*[]) { "/a//", "//b/", "/c/", NULL }), "/a/b/c");
     }
 
+    {
+        printf("## write_file_atomically\n");
+
+        char dir[] = "/tmp/ccodoc_test_XXXXXX";
+        if (mkdtemp(dir) == NULL) {
+            report_status(__FILE__, __LINE__, false, "dir", "failed to create", "created");
+            return EXIT_FAILURE;
+        }
+
+        const char* const path = join_paths((const char*[]) { dir, "sound.mp3", NULL });
+
+        static const struct test {
+            const char* label;
+            const char* data;
+        } tests[] = {
+            { "writes", "ccodoc" },
+            { "overwrites", "shishi-odoshi" },
+        };
+        static const size_t tests_len = sizeof(tests) / sizeof(struct test);
+
+        int result = EXIT_SUCCESS;
+
+        for (size_t i = 0; i < tests_len && result == EXIT_SUCCESS; i++) {
+            const struct test test = tests[i];
+            const size_t len = strlen(test.data);
+
+            {
+                const char* const err = write_file_atomically(path, (const unsigned char*)test.data, len);
+                if (err != NULL) {
+                    report_status(__FILE__, __LINE__, false, test.label, err, "no error");
+                    free((void*)err);
+                    result = EXIT_FAILURE;
+                    break;
+                }
+            }
+
+            char actual[1 << 5] = { 0 };
+            {
+                FILE* const file = fopen(path, "r");
+                if (file != NULL) {
+                    (void)fread(actual, sizeof(char), sizeof(actual) - 1, file);
+                    (void)fclose(file);
+                }
+            }
+
+            size_t size = 0;
+            const bool passes = get_file_size(path, &size) && size == len && str_equals(actual, test.data);
+            report_status_str(__FILE__, __LINE__, passes, test.label, actual, test.data);
+            if (!passes) {
+                result = EXIT_FAILURE;
+            }
+        }
+
+        // Nothing but the file is left behind.
+        unsigned int files = 0;
+        {
+            DIR* const entries = opendir(dir);
+            if (entries != NULL) {
+                for (const struct dirent* entry = readdir(entries); entry != NULL; entry = readdir(entries)) {
+                    if (!str_equals(entry->d_name, ".") && !str_equals(entry->d_name, "..")) {
+                        files++;
+                    }
+                }
+                (void)closedir(entries);
+            }
+        }
+
+        (void)unlink(path);
+        (void)rmdir(dir);
+        free((void*)path);
+
+        if (result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+
+        char actual[1 << 5] = { 0 };
+        (void)snprintf(actual, sizeof(actual), "%u files", files);
+
+        const bool passes = files == 1;
+        report_status(__FILE__, __LINE__, passes, "leaves no temporary file", actual, "1 files");
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
+#if PLATFORM == PLATFORM_LINUX
+    {
+        printf("## make_mem_file\n");
+
+        static const unsigned char data[] = "ccodoc";
+
+        int fd = -1;
+        const char* path = NULL;
+        {
+            const char* const err = make_mem_file("test", data, sizeof(data), &fd, &path);
+            if (err != NULL) {
+                report_status(__FILE__, __LINE__, false, "make", err, "no error");
+                free((void*)err);
+                return EXIT_FAILURE;
+            }
+        }
+
+        char actual[1 << 5] = { 0 };
+        bool written = true;
+        {
+            FILE* const file = fopen(path, "r+");
+            if (file != NULL) {
+                (void)fread(actual, sizeof(char), sizeof(actual) - 1, file);
+                // The file is sealed against any write.
+                written = fwrite("x", sizeof(char), 1, file) == 1 && fflush(file) == 0;
+                (void)fclose(file);
+            }
+        }
+
+        (void)close(fd);
+
+        const bool reads = str_equals(actual, (const char*)data);
+        report_status_str(__FILE__, __LINE__, reads, path, actual, (const char*)data);
+
+        free((void*)path);
+
+        if (!reads) {
+            return EXIT_FAILURE;
+        }
+
+        report_status(__FILE__, __LINE__, !written, "sealed", written ? "written" : "not written", "not written");
+        if (written) {
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
     return EXIT_SUCCESS;
 }
 
@@ -3,12 +3,85 @@
 #include "canvas.h"
 #include "ccodoc.h"
 #include "math.h"
-#include "string.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
+
+// art_cell is a cell of an art compiled in build time.
+// The cell whose code is 0 is transparent and left undrawn.
+struct art_cell {
+    uint32_t code;
+    struct drawing_attr attr;
+};
+
+struct art {
+    struct vec2d size;
+    const struct art_cell* cells;
+};
+
+#include "assets/arts/arts.h"
+
+// The arts switch at these progress ratios of the actions.
+static const float kakehi_holding_ratio_sho = 1.0f / 3 * 1;
+static const float kakehi_holding_ratio_ten = 1.0f / 3 * 2;
+static const double tsutsu_releasing_ratio_ha = 0.55;
+static const double hachi_releasing_ratio_kyu = 0.35;
+static const double hachi_releasing_ratio_jo = 0.65;
+
+enum { progress_bar_width = 14 };
+
+static const struct duration no_redraw_delay = { .nsecs = UINT64_MAX };
 
 static void draw_canvas(struct renderer* renderer, struct vec2d point, struct drawing_attr attr, const char* s);
 static void drawf_canvas(struct renderer* renderer, struct vec2d point, struct drawing_attr attr, const char* format, ...);
+static void draw_cell_canvas(struct renderer* renderer, struct vec2d point, struct drawing_attr attr, uint32_t code);
+static void draw_codes_canvas(struct renderer* renderer, struct vec2d point, struct drawing_attr attr, const uint32_t* codes, unsigned int len);
+static void rasterize_art(const struct renderer* renderer, struct canvas_buffer* sprite, const struct art* art);
+
+void init_renderer(struct renderer* const renderer, struct canvas* const canvas, const bool ornamental)
+{
+    *renderer = (struct renderer) {
+        .canvas = canvas,
+        .ornamental = ornamental,
+    };
+
+    rasterize_art(renderer, &renderer->sprites.kakehi.ki, &art_kakehi_ki);
+    rasterize_art(renderer, &renderer->sprites.kakehi.sho, &art_kakehi_sho);
+    rasterize_art(renderer, &renderer->sprites.kakehi.ten, &art_kakehi_ten);
+    rasterize_art(renderer, &renderer->sprites.kakehi.ketsu, &art_kakehi_ketsu);
+
+    rasterize_art(renderer, &renderer->sprites.tsutsu.jo, &art_tsutsu_jo);
+    rasterize_art(renderer, &renderer->sprites.tsutsu.ha, &art_tsutsu_ha);
+    rasterize_art(renderer, &renderer->sprites.tsutsu.kyu, &art_tsutsu_kyu);
+
+    rasterize_art(renderer, &renderer->sprites.hachi.jo, &art_hachi_jo);
+    rasterize_art(renderer, &renderer->sprites.hachi.ha, &art_hachi_ha);
+    rasterize_art(renderer, &renderer->sprites.hachi.kyu, &art_hachi_kyu);
+
+    rasterize_art(renderer, &renderer->sprites.roji, &art_roji);
+}
+
+void deinit_renderer(struct renderer* const renderer)
+{
+    struct canvas_buffer* const sprites[] = {
+        &renderer->sprites.kakehi.ki,
+        &renderer->sprites.kakehi.sho,
+        &renderer->sprites.kakehi.ten,
+        &renderer->sprites.kakehi.ketsu,
+        &renderer->sprites.tsutsu.jo,
+        &renderer->sprites.tsutsu.ha,
+        &renderer->sprites.tsutsu.kyu,
+        &renderer->sprites.hachi.jo,
+        &renderer->sprites.hachi.ha,
+        &renderer->sprites.hachi.kyu,
+        &renderer->sprites.roji,
+    };
+
+    for (size_t i = 0; i < sizeof(sprites) / sizeof(struct canvas_buffer*); i++) {
+        struct canvas canvas = wrap_canvas_buffer(sprites[i]);
+        deinit_canvas(&canvas);
+    }
+}
 
 static void render_kakehi(struct renderer* renderer, struct drawing_ctx* ctx, const struct kakehi* kakehi);
 static void render_tsutsu(struct renderer* renderer, struct drawing_ctx* ctx, const struct tsutsu* tsutsu);
@@ -29,100 +102,48 @@ void render_ccodoc(struct renderer* const renderer, struct drawing_ctx* const ct
 
 static void render_kakehi(struct renderer* const renderer, struct drawing_ctx* const ctx, const struct kakehi* const kakehi)
 {
-    static const char* const art_ki = u8"━══"; // ki（起）
-    static const char* const art_sho = u8"═━═"; // sho（承）
-    static const char* const art_ten = u8"══━"; // ten（転）
-    static const char* const art_ketsu = u8"═══"; // ketsu（結）
-
-    const char* art = NULL;
+    const struct canvas_buffer* sprite = NULL;
 
     switch (kakehi->state) {
     case holding_water: {
-        static const float holding_ratio_sho = 1.0f / 3 * 1;
-        static const float holding_ratio_ten = 1.0f / 3 * 2;
-
         const float ratio = get_action_progress_ratio(&kakehi->holding_water);
 
-        if (0 <= ratio && ratio < holding_ratio_sho) {
-            art = art_ki;
-        } else if (holding_ratio_sho <= ratio && ratio < holding_ratio_ten) {
-            art = art_sho;
+        if (0 <= ratio && ratio < kakehi_holding_ratio_sho) {
+            sprite = &renderer->sprites.kakehi.ki;
+        } else if (kakehi_holding_ratio_sho <= ratio && ratio < kakehi_holding_ratio_ten) {
+            sprite = &renderer->sprites.kakehi.sho;
         } else {
-            art = art_ten;
+            sprite = &renderer->sprites.kakehi.ten;
         }
 
         break;
     }
     case releasing_water:
-        art = art_ketsu;
+        sprite = &renderer->sprites.kakehi.ketsu;
         break;
     }
 
-    assert(art != NULL);
-
-    {
-        int i = 0;
-        for (const char* c = art; *c;) {
-            const struct char_descriptor desc = decode_char_utf8(c);
-            const bool has_water = str_equals_n(c, u8"━", desc.len);
+    assert(sprite != NULL);
 
-            drawf_canvas(
-                renderer,
-                vec2d_add(ctx->current, (struct vec2d) { .x = i }),
-                (struct drawing_attr) {
-                    .color = has_water ? color_blue : color_yellow,
-                },
-                "%.*s", desc.len, c
-            );
+    blit(renderer->canvas, ctx->current, sprite);
 
-            i++;
-            c += desc.len;
-        }
-    }
-
-    wrap_drawing_lines(ctx, 1);
+    wrap_drawing_lines(ctx, sprite->size.y);
 }
 
 static void render_tsutsu(struct renderer* const renderer, struct drawing_ctx* const ctx, const struct tsutsu* const tsutsu)
 {
-    static const size_t art_height = 4;
-
-    // jo (序)
-    static const char* const art_jo[] = {
-        u8"◥◣",
-        u8"  ◥◣",
-        u8"  ▕ ◥◣",
-        u8"  ▕   ◥◣",
-    };
-
-    // ha (破)
-    static const char* const art_ha[] = {
-        u8"",
-        u8"◢◤◢◤◢◤◢◤",
-        u8"  ▕ ",
-        u8"  ▕ ",
-    };
-
-    // kyu (急)
-    static const char* const art_kyu[] = {
-        u8"      ◢◤",
-        u8"    ◢◤",
-        u8"  ◢◤",
-        u8"◢◤▕",
-    };
-
-    const char* const* art = NULL;
+    const struct canvas_buffer* sprite = NULL;
 
     switch (tsutsu->state) {
     case holding_water: {
         const float ratio = get_tsutsu_water_amount_ratio(tsutsu);
 
         if (ratio < 0.8) {
-            art = art_jo;
+            sprite = &renderer->sprites.tsutsu.jo;
         } else if (ratio < 1) {
-            art = art_ha;
+            sprite = &renderer->sprites.tsutsu.ha;
         } else {
-            art = art_kyu;
+            sprite = &renderer->sprites.tsutsu.kyu;
         }
 
         break;
@@ -130,127 +151,60 @@ static void render_tsutsu(struct renderer* const renderer, struct drawing_ctx* c
     case releasing_water: {
         const float ratio = get_action_progress_ratio(&tsutsu->releasing_water);
 
-        if (ratio < 0.55) {
-            art = art_kyu;
+        if (ratio < tsutsu_releasing_ratio_ha) {
+            sprite = &renderer->sprites.tsutsu.kyu;
         } else if (ratio < 1) {
-            art = art_ha;
+            sprite = &renderer->sprites.tsutsu.ha;
         } else {
-            art = art_jo;
+            sprite = &renderer->sprites.tsutsu.jo;
         }
 
         break;
     }
     }
 
-    assert(art != NULL);
-
-    for (size_t h = 0; h < art_height; h++) {
-        int i = 0;
-        const char* c = art[h];
-        while (*c) {
-            const struct char_descriptor desc = decode_char_utf8(c);
-
-            struct drawing_attr attr = (struct drawing_attr) { .color = color_white };
-
-            if (
-                str_equals_n(c, u8"◥", desc.len)
-                || str_equals_n(c, u8"◣", desc.len)
-                || str_equals_n(c, u8"◢", desc.len)
-                || str_equals_n(c, u8"◤", desc.len)
-            ) {
-                attr.color = color_green;
-            }
-
-            if (str_equals_n(c, u8"▕", desc.len)) {
-                attr.color = color_yellow;
-            }
+    assert(sprite != NULL);
 
-            drawf_canvas(
-                renderer,
-                vec2d_add(ctx->current, (struct vec2d) { .y = h, .x = i }),
-                attr,
-                "%.*s", desc.len, c
-            );
+    blit(renderer->canvas, ctx->current, sprite);
 
-            i++;
-            c += desc.len;
-        }
-    }
-
-    wrap_drawing_lines(ctx, art_height);
+    wrap_drawing_lines(ctx, sprite->size.y);
 }
 
 static void render_hachi(struct renderer* const renderer, struct drawing_ctx* const ctx, const struct hachi* const hachi)
 {
-    static const unsigned int art_width = 4;
-
-    static const char* const art_jo = u8"▭▭▭▭";
-    static const char* const art_ha = u8"▭▬▬▭";
-    static const char* const art_kyu = u8"▬▭▭▬";
-
-    const char* art = NULL;
+    const struct canvas_buffer* sprite = NULL;
 
     switch (hachi->state) {
     case holding_water:
-        art = art_jo;
+        sprite = &renderer->sprites.hachi.jo;
         break;
     case releasing_water: {
         float ratio = get_action_progress_ratio(&hachi->releasing_water);
 
-        if (ratio < 0.35) {
-            art = art_ha;
-        } else if (ratio < 0.65) {
-            art = art_kyu;
+        if (ratio < hachi_releasing_ratio_kyu) {
+            sprite = &renderer->sprites.hachi.ha;
+        } else if (ratio < hachi_releasing_ratio_jo) {
+            sprite = &renderer->sprites.hachi.kyu;
         } else {
-            art = art_jo;
+            sprite = &renderer->sprites.hachi.jo;
         }
 
         break;
     }
     }
 
-    {
-        int i = 0;
-        const char* c = art;
-        while (*c) {
-            const struct char_descriptor desc = decode_char_utf8(c);
-            const bool has_water = str_equals_n(c, u8"▬", desc.len);
+    assert(sprite != NULL);
 
-            drawf_canvas(
-                renderer,
-                vec2d_add(ctx->current, (struct vec2d) { .x = i }),
-                (struct drawing_attr) {
-                    .color = has_water ? color_blue : color_grey,
-                },
-                "%.*s", desc.len, c
-            );
-
-            i++;
-            c += desc.len;
-        }
-    }
+    blit(renderer->canvas, ctx->current, sprite);
 
-    ctx->current = vec2d_add(ctx->current, (struct vec2d) { .x = art_width });
+    ctx->current = vec2d_add(ctx->current, (struct vec2d) { .x = sprite->size.x });
 }
 
 static void render_roji(struct renderer* const renderer, struct drawing_ctx* const ctx)
 {
-    draw_canvas(
-        renderer,
-        ctx->current,
-        (struct drawing_attr) { .color = color_green, .dim = true },
-        "━━━━━━"
-    );
-    ctx->current = vec2d_add(ctx->current, (struct vec2d) { .x = 6 });
-
-    draw_canvas(
-        renderer,
-        ctx->current,
-        (struct drawing_attr) { .color = color_grey },
-        "▨▨▨▨"
-    );
+    blit(renderer->canvas, ctx->current, &renderer->sprites.roji);
 
-    wrap_drawing_lines(ctx, 1);
+    wrap_drawing_lines(ctx, renderer->sprites.roji.size.y);
 }
 
 void render_timer(struct renderer* const renderer, struct drawing_ctx* const ctx, const struct timer* const timer)
@@ -259,25 +213,47 @@ void render_timer(struct renderer* const renderer, struct drawing_ctx* const ctx
         const struct moment moment = moment_from_duration(get_remaining_time(timer), time_min);
 
 #if PLATFORM != PLATFORM_MACOS
-        const char* const format = "%02dᴴ%02dᴹ";
+        static const uint32_t hours_unit = 0x1d34; // 'ᴴ'
+        static const uint32_t mins_unit = 0x1d39; // 'ᴹ'
 #else
         // Curses available in MacOS fails to handle some multibyte characters including 'ᴴ' and 'ᴹ',
         // requiring us to use alternative ones for them.
-        const char* const format = "%02dh%02dm";
+        static const uint32_t hours_unit = 'h';
+        static const uint32_t mins_unit = 'm';
 #endif
 
-        drawf_canvas(
+        // HHᴴMMᴹ, with all the digits of the hours however many there are.
+        uint32_t codes[1 << 4] = { 0 };
+        unsigned int len = 0;
+
+        {
+            uint32_t digits[1 << 4] = { 0 };
+            unsigned int digits_len = 0;
+            for (int hours = moment.hours; hours > 0 || digits_len < 2; hours /= 10) {
+                digits[digits_len++] = (uint32_t)('0' + hours % 10);
+            }
+
+            while (digits_len > 0) {
+                codes[len++] = digits[--digits_len];
+            }
+        }
+
+        codes[len++] = hours_unit;
+        codes[len++] = (uint32_t)('0' + moment.mins / 10 % 10);
+        codes[len++] = (uint32_t)('0' + moment.mins % 10);
+        codes[len++] = mins_unit;
+
+        draw_codes_canvas(
             renderer,
             vec2d_add(ctx->current, (struct vec2d) { .x = 4 }),
             (struct drawing_attr) { .color = color_white },
-            format, moment.hours, moment.mins
+            codes, len
         );
 
         wrap_drawing_lines(ctx, 1);
     }
 
     {
-        static const size_t progress_bar_width = 14;
         static const size_t progress_bar_index_timeout_away1 = (size_t)((float)progress_bar_width * 0.2f);
         static const size_t progress_bar_index_timeout_away2 = (size_t)((float)progress_bar_width * 0.4f);
 
@@ -300,12 +276,12 @@ void render_timer(struct renderer* const renderer, struct drawing_ctx* const ctx
 
             attr.dim = !remaining;
 
-            const char* art = "─";
+            uint32_t art = 0x2500; // '─'
             if (!renderer->ornamental) {
-                art = remaining ? "─" : " ";
+                art = remaining ? art : ' ';
             }
 
-            draw_canvas(
+            draw_cell_canvas(
                 renderer,
                 vec2d_add(ctx->current, (struct vec2d) { .x = i }),
                 attr,
@@ -317,6 +293,128 @@ void render_timer(struct renderer* const renderer, struct drawing_ctx* const ctx
     }
 }
 
+static struct duration get_action_redraw_delay(const action_t* action, const double* ratios, size_t len);
+static struct duration get_action_min_art_duration(const action_t* action, const double* ratios, size_t len);
+
+struct duration get_ccodoc_redraw_delay(const struct ccodoc* const ccodoc)
+{
+    struct duration delay = no_redraw_delay;
+
+    {
+        const struct kakehi* const kakehi = &ccodoc->kakehi;
+
+        if (!kakehi->disabled) {
+            switch (kakehi->state) {
+            case holding_water: {
+                const double ratios[] = { kakehi_holding_ratio_sho, kakehi_holding_ratio_ten, 1 };
+                const struct duration d = get_action_redraw_delay(&kakehi->holding_water, ratios, sizeof(ratios) / sizeof(double));
+                delay.nsecs = MIN(delay.nsecs, d.nsecs);
+                break;
+            }
+            case releasing_water: {
+                const double ratios[] = { 1 };
+                const struct duration d = get_action_redraw_delay(&kakehi->releasing_water, ratios, sizeof(ratios) / sizeof(double));
+                delay.nsecs = MIN(delay.nsecs, d.nsecs);
+                break;
+            }
+            }
+        }
+    }
+
+    // The tsutsu fills up only with the drips from the kakehi, which the kakehi schedules.
+    if (ccodoc->tsutsu.state == releasing_water) {
+        const double ratios[] = { tsutsu_releasing_ratio_ha, 1 };
+        const struct duration d = get_action_redraw_delay(&ccodoc->tsutsu.releasing_water, ratios, sizeof(ratios) / sizeof(double));
+        delay.nsecs = MIN(delay.nsecs, d.nsecs);
+    }
+
+    if (ccodoc->hachi.state == releasing_water) {
+        const double ratios[] = { hachi_releasing_ratio_kyu, hachi_releasing_ratio_jo, 1 };
+        const struct duration d = get_action_redraw_delay(&ccodoc->hachi.releasing_water, ratios, sizeof(ratios) / sizeof(double));
+        delay.nsecs = MIN(delay.nsecs, d.nsecs);
+    }
+
+    return delay;
+}
+
+struct duration get_timer_redraw_delay(const struct timer* const timer)
+{
+    const struct duration remaining = get_remaining_time(timer);
+    if (remaining.nsecs == 0) {
+        return no_redraw_delay;
+    }
+
+    // The minutes are rounded up, so they switch when the remaining time reaches a whole minute.
+    const struct duration until_min = { .nsecs = (remaining.nsecs - 1) % NSECS_FROM_MSECS(time_min) + 1 };
+
+    // The progress bar loses a cell each time the elapsed time ratio reaches a multiple of its width.
+    const double ratio = floor((double)get_elapsed_time_ratio(timer) * progress_bar_width + 1) / progress_bar_width;
+    const struct duration until_cell = get_time_until_ratio(timer, MIN(ratio, 1));
+
+    return (struct duration) { .nsecs = MIN(until_min.nsecs, until_cell.nsecs) };
+}
+
+struct duration get_ccodoc_min_art_duration(const struct ccodoc* const ccodoc)
+{
+    struct duration duration = no_redraw_delay;
+
+    {
+        const double ratios[] = { kakehi_holding_ratio_sho, kakehi_holding_ratio_ten, 1 };
+        const struct duration d = get_action_min_art_duration(&ccodoc->kakehi.holding_water, ratios, sizeof(ratios) / sizeof(double));
+        duration.nsecs = MIN(duration.nsecs, d.nsecs);
+    }
+
+    {
+        const double ratios[] = { 1 };
+        const struct duration d = get_action_min_art_duration(&ccodoc->kakehi.releasing_water, ratios, sizeof(ratios) / sizeof(double));
+        duration.nsecs = MIN(duration.nsecs, d.nsecs);
+    }
+
+    {
+        const double ratios[] = { tsutsu_releasing_ratio_ha, 1 };
+        const struct duration d = get_action_min_art_duration(&ccodoc->tsutsu.releasing_water, ratios, sizeof(ratios) / sizeof(double));
+        duration.nsecs = MIN(duration.nsecs, d.nsecs);
+    }
+
+    {
+        const double ratios[] = { hachi_releasing_ratio_kyu, hachi_releasing_ratio_jo, 1 };
+        const struct duration d = get_action_min_art_duration(&ccodoc->hachi.releasing_water, ratios, sizeof(ratios) / sizeof(double));
+        duration.nsecs = MIN(duration.nsecs, d.nsecs);
+    }
+
+    return duration;
+}
+
+// get_action_redraw_delay returns the time left until the progress of the action reaches the next one of the ratios,
+// which are in ascending order.
+static struct duration get_action_redraw_delay(const action_t* const action, const double* const ratios, const size_t len)
+{
+    const float ratio = get_action_progress_ratio(action);
+
+    for (size_t i = 0; i < len; i++) {
+        if (ratio < ratios[i]) {
+            return get_time_until_ratio(action, ratios[i]);
+        }
+    }
+
+    // The action has finished and waits for the next tick to move on.
+    return (struct duration) { 0 };
+}
+
+// get_action_min_art_duration returns the shortest time between the ratios the art switches at during the action,
+// which are in ascending order.
+static struct duration get_action_min_art_duration(const action_t* const action, const double* const ratios, const size_t len)
+{
+    struct duration duration = no_redraw_delay;
+
+    for (size_t i = 0; i < len; i++) {
+        const double ratio = ratios[i] - (i > 0 ? ratios[i - 1] : 0);
+        duration.nsecs = MIN(duration.nsecs, scale_duration(action->duration, ratio).nsecs);
+    }
+
+    return duration;
+}
+
 static void render_debug_info_ccodoc(struct renderer* renderer, struct drawing_ctx* ctx, const struct ccodoc* ccodoc);
 static void render_debug_info_timer(struct renderer* renderer, struct drawing_ctx* ctx, const struct timer* timer);
 static const char* water_flow_state_to_str(enum water_flow_state state);
@@ -324,6 +422,8 @@ static const char* water_flow_state_to_str(enum water_flow_state state);
 void render_debug_info(
     struct renderer* const renderer,
     const struct duration delta,
+    const struct frame_pacing* const pacing,
+    const unsigned long dropped_sounds,
     const struct ccodoc* const ccodoc,
     const struct timer* const timer
 )
@@ -350,7 +450,33 @@ void render_debug_info(
             renderer,
             ctx.current,
             ctx.attr,
-            "fps: %d", delta.msecs != 0 ? (int)round(1000.0 / (double)delta.msecs) : 0
+            "fps: %d", delta.nsecs != 0 ? (int)round((double)NSECS_FROM_MSECS(time_sec) / (double)delta.nsecs) : 0
+        );
+        wrap_drawing_lines(&ctx, 1);
+
+        drawf_canvas(
+            renderer,
+            ctx.current,
+            ctx.attr,
+            "jitter: %.2fms (max: %.2fms)",
+            (double)pacing->jitter.nsecs / (double)NSECS_FROM_MSECS(1),
+            (double)pacing->max_jitter.nsecs / (double)NSECS_FROM_MSECS(1)
+        );
+        wrap_drawing_lines(&ctx, 1);
+
+        drawf_canvas(
+            renderer,
+            ctx.current,
+            ctx.attr,
+            "overruns: %lu", pacing->overruns
+        );
+        wrap_drawing_lines(&ctx, 1);
+
+        drawf_canvas(
+            renderer,
+            ctx.current,
+            ctx.attr,
+            "dropped sounds: %lu", dropped_sounds
         );
         wrap_drawing_lines(&ctx, 1);
     }
@@ -512,3 +638,42 @@ static void drawf_canvas(struct renderer* const renderer, const struct vec2d poi
 
     va_end(args);
 }
+
+static void draw_cell_canvas(struct renderer* const renderer, const struct vec2d point, const struct drawing_attr attr, const uint32_t code)
+{
+    const struct drawing_attr attr2 = renderer->ornamental ? attr : (struct drawing_attr) { 0 };
+    draw_cell(renderer->canvas, point, attr2, code);
+}
+
+static void draw_codes_canvas(
+    struct renderer* const renderer,
+    const struct vec2d point,
+    const struct drawing_attr attr,
+    const uint32_t* const codes, const unsigned int len
+)
+{
+    const struct drawing_attr attr2 = renderer->ornamental ? attr : (struct drawing_attr) { 0 };
+    draw_codes(renderer->canvas, point, attr2, codes, len);
+}
+
+static void rasterize_art(const struct renderer* const renderer, struct canvas_buffer* const sprite, const struct art* const art)
+{
+    init_canvas_buffer(sprite, art->size);
+
+    struct canvas canvas = wrap_canvas_buffer(sprite);
+
+    for (unsigned int h = 0; h < art->size.y; h++) {
+        const struct art_cell* const row = &art->cells[h * art->size.x];
+
+        for (unsigned int w = 0; w < art->size.x; w++) {
+            if (row[w].code == 0) {
+                continue;
+            }
+
+            const struct drawing_attr attr = renderer->ornamental ? row[w].attr : (struct drawing_attr) { 0 };
+            draw_cell(&canvas, (struct vec2d) { .x = w, .y = h }, attr, row[w].code);
+        }
+    }
+
+    flush_canvas(&canvas);
+}
@@ -7,6 +7,30 @@ struct renderer {
     struct canvas* canvas;
 
     bool ornamental;
+
+    // sprites hold the arts of each state of the ccodoc, rasterized once on init.
+    struct {
+        struct {
+            struct canvas_buffer ki;
+            struct canvas_buffer sho;
+            struct canvas_buffer ten;
+            struct canvas_buffer ketsu;
+        } kakehi;
+
+        struct {
+            struct canvas_buffer jo;
+            struct canvas_buffer ha;
+            struct canvas_buffer kyu;
+        } tsutsu;
+
+        struct {
+            struct canvas_buffer jo;
+            struct canvas_buffer ha;
+            struct canvas_buffer kyu;
+        } hachi;
+
+        struct canvas_buffer roji;
+    } sprites;
 };
 
 #define RENDER(r, ...)                    \
@@ -17,9 +41,19 @@ struct renderer {
         flush_canvas(renderer_->canvas);  \
     }
 
+extern void init_renderer(struct renderer* renderer, struct canvas* canvas, bool ornamental);
+extern void deinit_renderer(struct renderer* renderer);
+
 extern void render_ccodoc(struct renderer* renderer, struct drawing_ctx* ctx, const struct ccodoc* ccodoc);
 extern void render_timer(struct renderer* renderer, struct drawing_ctx* ctx, const struct timer* timer);
+// The redraw delays are the times until the arts change next, or UINT64_MAX nsecs if they never change by themselves.
+extern struct duration get_ccodoc_redraw_delay(const struct ccodoc* ccodoc);
+extern struct duration get_timer_redraw_delay(const struct timer* timer);
+// get_ccodoc_min_art_duration returns the shortest time any art of the ccodoc stays the same.
+extern struct duration get_ccodoc_min_art_duration(const struct ccodoc* ccodoc);
+
 extern void render_debug_info(
     struct renderer* renderer,
-    struct duration delta, const struct ccodoc* ccodoc, const struct timer* timer
+    struct duration delta, const struct frame_pacing* pacing, unsigned long dropped_sounds,
+    const struct ccodoc* ccodoc, const struct timer* timer
 );
@@ -5,6 +5,7 @@
 #include "test.h"
 #include "time.h"
 #include <assert.h>
+#include <inttypes.h>
 #include <stdio.h>
 
 static void tick_for(struct duration delta, struct ccodoc* ccodoc, struct timer* timer);
@@ -22,27 +23,28 @@ int test_renderer(void)
 
         struct canvas canvas = wrap_canvas_buffer(&canvas_buffer);
 
-        struct renderer renderer = { .canvas = &canvas };
+        struct renderer renderer = { 0 };
+        init_renderer(&renderer, &canvas, false);
 
         struct ccodoc ccodoc = {
             .kakehi = {
                 .release_water_amount = 2,
                 .holding_water = {
-                    .duration = { .msecs = 2100 },
+                    .duration = { .nsecs = NSECS_FROM_MSECS(2100) },
                 },
                 .releasing_water = {
-                    .duration = { .msecs = 900 },
+                    .duration = { .nsecs = NSECS_FROM_MSECS(900) },
                 },
             },
             .tsutsu = {
                 .water_capacity = 10,
                 .releasing_water = {
-                    .duration = { .msecs = 1200 },
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1200) },
                 },
             },
             .hachi = {
                 .releasing_water = {
-                    .duration = { .msecs = 1000 },
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
                 },
             },
         };
@@ -52,7 +54,7 @@ int test_renderer(void)
             const char* expected;
         } tests[] = {
             (struct test) {
-                .delta = { .msecs = 0 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(0) },
                 .expected = "                "
                             " ━══            "
                             "    ◥◣          "
@@ -63,7 +65,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ━══            "
                             "    ◥◣          "
@@ -74,7 +76,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ═━═            "
                             "    ◥◣          "
@@ -85,7 +87,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ═━═            "
                             "    ◥◣          "
@@ -96,7 +98,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ══━            "
                             "    ◥◣          "
@@ -107,7 +109,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ══━            "
                             "    ◥◣          "
@@ -118,7 +120,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 350 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(350) },
                 .expected = "                "
                             " ═══            "
                             "    ◥◣          "
@@ -129,7 +131,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 450 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(450) },
                 .expected = "                "
                             " ═══            "
                             "    ◥◣          "
@@ -140,7 +142,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 450 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(450) },
                 .expected = "                "
                             " ━══            "
                             "    ◥◣          "
@@ -151,7 +153,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 700 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(700) },
                 .expected = "                "
                             " ═━═            "
                             "    ◥◣          "
@@ -162,7 +164,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 700 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(700) },
                 .expected = "                "
                             " ══━            "
                             "    ◥◣          "
@@ -173,7 +175,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 700 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(700) },
                 .expected = "                "
                             " ═══            "
                             "    ◥◣          "
@@ -184,7 +186,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 900 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(900) },
                 .expected = "                "
                             " ━══            "
                             "    ◥◣          "
@@ -195,7 +197,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 6000 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(6000) },
                 .expected = "                "
                             " ━══            "
                             "                "
@@ -206,7 +208,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 2100 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(2100) },
                 .expected = "                "
                             " ═══            "
                             "          ◢◤    "
@@ -217,7 +219,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 150 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(150) },
                 .expected = "                "
                             " ═══            "
                             "          ◢◤    "
@@ -228,18 +230,18 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 150 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(150) },
                 .expected = "                "
                             " ═══            "
                             "          ◢◤    "
                             "        ◢◤      "
                             "      ◢◤        "
                             "    ◢◤▕         "
-                            " ▬▭▭▬━━━━━━▨▨▨▨ "
+                            " ▭▬▬▭━━━━━━▨▨▨▨ "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 150 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(150) },
                 .expected = "                "
                             " ═══            "
                             "          ◢◤    "
@@ -250,18 +252,18 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 150 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(150) },
                 .expected = "                "
                             " ═══            "
                             "          ◢◤    "
                             "        ◢◤      "
                             "      ◢◤        "
                             "    ◢◤▕         "
-                            " ▭▭▭▭━━━━━━▨▨▨▨ "
+                            " ▬▭▭▬━━━━━━▨▨▨▨ "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 300 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(300) },
                 .expected = "                "
                             " ━══            "
                             "                "
@@ -272,7 +274,7 @@ int test_renderer(void)
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 300 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(300) },
                 .expected = "                "
                             " ━══            "
                             "    ◥◣          "
@@ -302,6 +304,7 @@ int test_renderer(void)
             EXPECT_CANVAS(renderer.canvas->delegate.buffer, test.expected);
         }
 
+        deinit_renderer(&renderer);
         deinit_canvas(&canvas);
     }
 
@@ -313,7 +316,8 @@ int test_renderer(void)
 
         struct canvas canvas = wrap_canvas_buffer(&canvas_buffer);
 
-        struct renderer renderer = { .canvas = &canvas };
+        struct renderer renderer = { 0 };
+        init_renderer(&renderer, &canvas, false);
 
         struct timer timer = {
             .duration = duration_from_moment((struct moment) { .mins = 5 }),
@@ -324,42 +328,42 @@ int test_renderer(void)
             const char* expected;
         } tests[] = {
             (struct test) {
-                .delta = { .msecs = 0 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(0) },
                 .expected = "                "
                             "     00ᴴ05ᴹ     "
                             " ────────────── "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = (long)30 * time_sec },
+                .delta = { .nsecs = NSECS_FROM_MSECS((long)30 * time_sec) },
                 .expected = "                "
                             "     00ᴴ05ᴹ     "
                             " ─────────────  "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = (long)30 * time_sec },
+                .delta = { .nsecs = NSECS_FROM_MSECS((long)30 * time_sec) },
                 .expected = "                "
                             "     00ᴴ04ᴹ     "
                             " ────────────   "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = (long)2 * time_min },
+                .delta = { .nsecs = NSECS_FROM_MSECS((long)2 * time_min) },
                 .expected = "                "
                             "     00ᴴ02ᴹ     "
                             " ──────         "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = (long)1 * time_min + (long)39 * time_sec },
+                .delta = { .nsecs = NSECS_FROM_MSECS((long)1 * time_min + (long)39 * time_sec) },
                 .expected = "                "
                             "     00ᴴ01ᴹ     "
                             " ─              "
                             "                ",
             },
             (struct test) {
-                .delta = { .msecs = 21000 },
+                .delta = { .nsecs = NSECS_FROM_MSECS(21000) },
                 .expected = "                "
                             "     00ᴴ00ᴹ     "
                             "                "
@@ -386,19 +390,143 @@ int test_renderer(void)
             EXPECT_CANVAS(renderer.canvas->delegate.buffer, test.expected);
         }
 
+        deinit_renderer(&renderer);
+        deinit_canvas(&canvas);
+    }
+
+    {
+        printf("\n## timer over 99 hours\n");
+
+        struct canvas_buffer canvas_buffer = { 0 };
+        init_canvas_buffer(&canvas_buffer, (struct vec2d) { .x = 14 + 2, .y = 2 + 2 });
+
+        struct canvas canvas = wrap_canvas_buffer(&canvas_buffer);
+
+        struct renderer renderer = { 0 };
+        init_renderer(&renderer, &canvas, false);
+
+        // --sabi 99:99
+        const struct timer timer = {
+            .duration = duration_from_moment((struct moment) { .hours = 99, .mins = 99 }),
+        };
+
+        RENDER(&renderer, {
+            struct drawing_ctx ctx = {
+                .origin = { .x = 1, .y = 1 }
+            };
+            ctx.current = ctx.origin;
+
+            render_timer(&renderer, &ctx, &timer);
+        });
+
+        EXPECT_CANVAS(
+            renderer.canvas->delegate.buffer,
+            "                "
+            "     100ᴴ39ᴹ    "
+            " ────────────── "
+            "                "
+        );
+
+        deinit_renderer(&renderer);
         deinit_canvas(&canvas);
     }
 
+    {
+        printf("\n## redraw delay\n");
+
+        struct canvas_buffer buffers[2] = { 0 };
+        for (size_t i = 0; i < 2; i++) {
+            init_canvas_buffer(&buffers[i], (struct vec2d) { .x = 14 + 2, .y = 6 + 2 + 2 });
+        }
+
+        struct renderer renderer = { 0 };
+        init_renderer(&renderer, NULL, false);
+
+        struct ccodoc ccodoc = {
+            .kakehi = {
+                .release_water_amount = 1,
+                .holding_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(2200) },
+                },
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(800) },
+                },
+            },
+            .tsutsu = {
+                .water_capacity = 10,
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1200) },
+                },
+            },
+            .hachi = {
+                .releasing_water = {
+                    .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
+                },
+            },
+        };
+
+        struct timer timer = {
+            .duration = duration_from_moment((struct moment) { .mins = 2 }),
+        };
+
+        // Render every msec and see that nothing changes before the delay reported on the last frame passes.
+        char actual[1 << 6] = "none";
+        struct duration delay = { 0 };
+
+        for (uint64_t time = 0; time <= msecs_from_duration(timer.duration); time++) {
+            struct canvas_buffer* const current = &buffers[time % 2];
+            const struct canvas_buffer* const prev = &buffers[(time + 1) % 2];
+
+            if (time != 0) {
+                tick_for((struct duration) { .nsecs = NSECS_FROM_MSECS(1) }, &ccodoc, &timer);
+            }
+
+            struct canvas canvas = wrap_canvas_buffer(current);
+            renderer.canvas = &canvas;
+
+            RENDER(&renderer, {
+                struct drawing_ctx ctx = {
+                    .origin = { .x = 1, .y = 1 }
+                };
+                ctx.current = ctx.origin;
+
+                render_ccodoc(&renderer, &ctx, &ccodoc);
+                render_timer(&renderer, &ctx, &timer);
+            });
+
+            struct canvas_diff_run run = { 0 };
+            if (time != 0 && delay.nsecs > NSECS_FROM_MSECS(1) && find_canvas_diff_run(current, prev, (struct vec2d) { 0 }, &run)) {
+                (void)snprintf(actual, sizeof(actual), "changed at %" PRIu64 "ms with %" PRIu64 "ms left", time, msecs_from_duration(delay) - 1);
+                break;
+            }
+
+            delay.nsecs = MIN(get_ccodoc_redraw_delay(&ccodoc).nsecs, get_timer_redraw_delay(&timer).nsecs);
+        }
+
+        const bool passes = str_equals(actual, "none");
+        report_status(__FILE__, __LINE__, passes, "changes before the delay", actual, "none");
+
+        deinit_renderer(&renderer);
+        for (size_t i = 0; i < 2; i++) {
+            struct canvas canvas = wrap_canvas_buffer(&buffers[i]);
+            deinit_canvas(&canvas);
+        }
+
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
 static void tick_for(const struct duration delta, struct ccodoc* const ccodoc, struct timer* const timer)
 {
-    static const struct duration min_delta = { .msecs = 100 };
+    static const struct duration min_delta = { .nsecs = NSECS_FROM_MSECS(100) };
 
-    for (struct duration elapsed = { 0 }; elapsed.msecs < delta.msecs;) {
+    for (struct duration elapsed = { 0 }; elapsed.nsecs < delta.nsecs;) {
         const struct duration d = {
-            .msecs = MIN(min_delta.msecs, delta.msecs - elapsed.msecs),
+            .nsecs = MIN(min_delta.nsecs, delta.nsecs - elapsed.nsecs),
         };
 
         if (ccodoc != NULL) {
@@ -408,7 +536,7 @@ static void tick_for(const struct duration delta, struct ccodoc* const ccodoc, s
             tick_timer(timer, d);
         }
 
-        elapsed.msecs += d.msecs;
+        elapsed.nsecs += d.nsecs;
     }
 }
 
@@ -416,10 +544,8 @@ static void print_canvas(const struct canvas_buffer* const canvas)
 {
     for (unsigned int h = 0; h < canvas->size.y; h++) {
         for (unsigned int w = 0; w < canvas->size.x; w++) {
-            const unsigned int i = h * canvas->size.x + w;
-
             char s[5] = { 0 };
-            uint32_t code = canvas->data[i].code;
+            uint32_t code = get_canvas_buffer_code(canvas, (struct vec2d) { .x = w, .y = h });
             encode_char_utf8(s, code);
             printf("%s", s);
         }
@@ -443,7 +569,7 @@ static int expect_canvas(const char* const file, const int line, const struct ca
 
             const struct char_descriptor expected_char = expected_chars[i];
 
-            const uint32_t code = actual->data[i].code;
+            const uint32_t code = get_canvas_buffer_code(actual, (struct vec2d) { .x = w, .y = h });
             if (code != expected_char.code) {
                 char label[1 << 5] = { 0 };
                 (void)snprintf(label, sizeof(label), "%d:%d", h, w);
@@ -0,0 +1,245 @@
+#include "sound.h"
+
+#include "string.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char* restart_remote_player(struct remote_player* player);
+
+static const char* init_wake_pipe(int* fds);
+static void wake_worker(const struct sound_player* player);
+static void* run_worker(struct sound_player* player);
+
+// init_sound_player starts the worker playing the sounds queued with the function.
+// The sounds are played in place on the caller thread if the worker fails to start.
+const char* init_sound_player(struct sound_player* const player, void* const ctx, const play_sound_t play)
+{
+    *player = (struct sound_player) {
+        .ctx = ctx,
+        .play = play,
+        .wake = { -1, -1 },
+    };
+
+    {
+        const char* const err = init_wake_pipe(player->wake);
+        if (err != NULL) {
+            const char* const err2 = format_str("failed to init wake pipe: %s", err);
+            free((void*)err);
+            return err2;
+        }
+    }
+
+    // Leave all the signals to the other threads, such as the signalfd the signals are read from on Linux,
+    // which catches the signals only when every thread blocks them.
+    sigset_t sigs = { 0 };
+    sigset_t last_sigs = { 0 };
+    (void)sigfillset(&sigs);
+    (void)pthread_sigmask(SIG_BLOCK, &sigs, &last_sigs);
+
+    const int status = pthread_create(&player->worker, NULL, (void* (*)(void*))run_worker, player);
+
+    (void)pthread_sigmask(SIG_SETMASK, &last_sigs, NULL);
+
+    if (status != 0) {
+        (void)close(player->wake[0]);
+        (void)close(player->wake[1]);
+        player->wake[0] = -1;
+        player->wake[1] = -1;
+        return format_str("failed to create sound worker: %d", status);
+    }
+
+    player->started = true;
+
+    return NULL;
+}
+
+// deinit_sound_player stops the worker after it plays the sounds already queued.
+void deinit_sound_player(struct sound_player* const player)
+{
+    if (!player->started) {
+        return;
+    }
+
+    atomic_store(&player->stopping, true);
+    wake_worker(player);
+
+    (void)pthread_join(player->worker, NULL);
+    player->started = false;
+
+    (void)close(player->wake[0]);
+    (void)close(player->wake[1]);
+}
+
+// queue_sound hands the sound over to the worker without blocking, or drops it if the queue is full.
+void queue_sound(struct sound_player* const player, const char* const file)
+{
+    if (!player->started) {
+        if (player->play != NULL) {
+            player->play(player->ctx, file);
+        }
+        return;
+    }
+
+    if (!push_sound_queue(&player->queue, file)) {
+        atomic_fetch_add(&player->dropped, 1);
+        return;
+    }
+
+    wake_worker(player);
+}
+
+unsigned long get_dropped_sounds(struct sound_player* const player)
+{
+    return atomic_load(&player->dropped);
+}
+
+// push_sound_queue pushes the file unless the queue is full, which only one thread may do at a time.
+bool push_sound_queue(struct sound_queue* const queue, const char* const file)
+{
+    const unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    const unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (tail - head >= sound_queue_capacity) {
+        return false;
+    }
+
+    queue->files[tail % sound_queue_capacity] = file;
+    // Publish the file along with the tail.
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+// pop_sound_queue pops the oldest file unless the queue is empty, which only one thread may do at a time.
+bool pop_sound_queue(struct sound_queue* const queue, const char** const file)
+{
+    const unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    const unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *file = queue->files[head % sound_queue_capacity];
+    // Hand the slot back only after reading the file out of it.
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+// start_remote_player starts the player with the args, which must outlive the player.
+const char* start_remote_player(struct remote_player* const player, const char* const path, const char* const* const args)
+{
+    *player = (struct remote_player) {
+        .path = path,
+        .args = args,
+    };
+
+    return start_cmd_pipe(&player->cmd, path, args);
+}
+
+void stop_remote_player(struct remote_player* const player)
+{
+    stop_cmd_pipe(&player->cmd);
+}
+
+// load_remote_player has the player load and play the file, starting the player again if it has died.
+const char* load_remote_player(struct remote_player* const player, const char* const file)
+{
+    if (!cmd_pipe_runs(&player->cmd)) {
+        const char* const err = restart_remote_player(player);
+        if (err != NULL) {
+            return err;
+        }
+    }
+
+    const char* const line = format_str("LOAD %s\n", file);
+
+    const char* err = write_cmd_pipe(&player->cmd, line);
+    if (err != NULL) {
+        // The player may have died after the check.
+        free((void*)err);
+
+        err = restart_remote_player(player);
+        if (err == NULL) {
+            err = write_cmd_pipe(&player->cmd, line);
+        }
+    }
+
+    free((void*)line);
+
+    if (err != NULL) {
+        const char* const err2 = format_str("failed to load sound: %s", err);
+        free((void*)err);
+        return err2;
+    }
+
+    return NULL;
+}
+
+static const char* restart_remote_player(struct remote_player* const player)
+{
+    stop_cmd_pipe(&player->cmd);
+
+    const char* const err = start_cmd_pipe(&player->cmd, player->path, player->args);
+    if (err != NULL) {
+        const char* const err2 = format_str("failed to restart player: %s", err);
+        free((void*)err);
+        return err2;
+    }
+
+    return NULL;
+}
+
+// init_wake_pipe opens the pipe whose write end never blocks, as a byte left unread is enough to wake up the worker.
+static const char* init_wake_pipe(int* const fds)
+{
+    errno = 0;
+    if (pipe(fds) != 0) {
+        return format_str("%d", errno);
+    }
+
+    const bool configured = fcntl(fds[0], F_SETFD, FD_CLOEXEC) == 0
+        && fcntl(fds[1], F_SETFD, FD_CLOEXEC) == 0
+        && fcntl(fds[1], F_SETFL, O_NONBLOCK) == 0;
+    if (!configured) {
+        const int err = errno;
+        (void)close(fds[0]);
+        (void)close(fds[1]);
+        return format_str("%d", err);
+    }
+
+    return NULL;
+}
+
+static void wake_worker(const struct sound_player* const player)
+{
+    static const char wake = 1;
+
+    // The write fails only when the pipe is full of wake-ups, in which case the worker is awake anyway.
+    const ssize_t n = write(player->wake[1], &wake, sizeof(wake));
+    (void)n;
+}
+
+static void* run_worker(struct sound_player* const player)
+{
+    while (true) {
+        const char* file = NULL;
+        while (pop_sound_queue(&player->queue, &file)) {
+            player->play(player->ctx, file);
+        }
+
+        if (atomic_load(&player->stopping)) {
+            return NULL;
+        }
+
+        char buf[1 << 4] = { 0 };
+        const ssize_t n = read(player->wake[0], buf, sizeof(buf));
+        if (n < 0 && errno != EINTR) {
+            return NULL;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "platform.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+typedef void (*play_sound_t)(void*, const char*);
+
+enum { sound_queue_capacity = 8 };
+
+// sound_queue is a bounded ring of the sounds to play, which one thread pushes to and another pops from without locks.
+struct sound_queue {
+    const char* files[sound_queue_capacity];
+
+    // head and tail count the sounds popped and pushed so far, which wrap around together.
+    atomic_uint head;
+    atomic_uint tail;
+};
+
+// sound_player plays the sounds queued from the frame thread on a worker thread,
+// so that starting players never blocks the frames.
+// Sounds queued while the queue is full are dropped and counted, rather than waited for.
+struct sound_player {
+    void* ctx;
+    play_sound_t play;
+
+    struct sound_queue queue;
+    atomic_ulong dropped;
+
+    bool started;
+    pthread_t worker;
+    // wake is the pipe whose write end wakes up the worker for the sounds queued, or to stop.
+    int wake[2];
+    atomic_bool stopping;
+};
+
+// remote_player keeps a player running in its remote control mode, such as `mpg123 -R`,
+// which loads the sounds sent over its standard input instead of starting for each of them.
+// The player is started again once it dies.
+struct remote_player {
+    const char* path;
+    const char* const* args;
+
+    struct cmd_pipe cmd;
+};
+
+extern const char* init_sound_player(struct sound_player* player, void* ctx, play_sound_t play);
+extern void deinit_sound_player(struct sound_player* player);
+
+extern void queue_sound(struct sound_player* player, const char* file);
+extern unsigned long get_dropped_sounds(struct sound_player* player);
+
+extern bool push_sound_queue(struct sound_queue* queue, const char* file);
+extern bool pop_sound_queue(struct sound_queue* queue, const char** file);
+
+extern const char* start_remote_player(struct remote_player* player, const char* path, const char* const* args);
+extern void stop_remote_player(struct remote_player* player);
+extern const char* load_remote_player(struct remote_player* player, const char* file);
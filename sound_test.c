@@ -0,0 +1,214 @@
+#include "sound.h"
+
+#include "string.h"
+#include "test.h"
+#include "time.h"
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct played_sounds {
+    const char* files[1 << 4];
+    unsigned int len;
+};
+
+static void record_sound(struct played_sounds* played, const char* file);
+static bool wait_for_file(const char* path, const char* expected, char* actual, size_t len);
+
+int test_sound(void)
+{
+    {
+        printf("## sound queue\n");
+
+        struct sound_queue queue = { 0 };
+
+        static const char* const files[] = { "a", "b", "c", "d", "e", "f", "g", "h" };
+
+        for (size_t i = 0; i < sound_queue_capacity; i++) {
+            const bool passes = push_sound_queue(&queue, files[i]);
+            report_status(__FILE__, __LINE__, passes, files[i], passes ? "pushed" : "dropped", "pushed");
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        {
+            const bool passes = !push_sound_queue(&queue, "i");
+            report_status(__FILE__, __LINE__, passes, "full", passes ? "dropped" : "pushed", "dropped");
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Pop and push again across the end of the ring.
+        for (size_t i = 0; i < sound_queue_capacity * 2; i++) {
+            const char* file = NULL;
+            const bool popped = pop_sound_queue(&queue, &file);
+
+            const char* const expected = files[i % sound_queue_capacity];
+            const bool passes = popped && str_equals(file, expected);
+            report_status_str(__FILE__, __LINE__, passes, "in order", popped ? file : "none", expected);
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+
+            (void)push_sound_queue(&queue, expected);
+        }
+    }
+
+    {
+        printf("## sound player\n");
+
+        struct played_sounds played = { 0 };
+
+        struct sound_player player = { 0 };
+        {
+            const char* const err = init_sound_player(&player, &played, (play_sound_t)record_sound);
+            if (err != NULL) {
+                report_status(__FILE__, __LINE__, false, "init", err, "no error");
+                free((void*)err);
+                return EXIT_FAILURE;
+            }
+        }
+
+        static const char* const files[] = { "tsutsu_drip.mp3", "tsutsu_bump.mp3", "uguisu_call.mp3" };
+        static const size_t files_len = sizeof(files) / sizeof(const char*);
+
+        for (size_t i = 0; i < files_len; i++) {
+            queue_sound(&player, files[i]);
+        }
+
+        // The worker plays the sounds queued before it stops.
+        deinit_sound_player(&player);
+
+        for (size_t i = 0; i < files_len; i++) {
+            const char* const actual = i < played.len ? played.files[i] : "none";
+
+            const bool passes = str_equals(actual, files[i]);
+            report_status_str(__FILE__, __LINE__, passes, "plays in order", actual, files[i]);
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        {
+            char actual[1 << 5] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%lu", get_dropped_sounds(&player));
+
+            const bool passes = str_equals(actual, "0");
+            report_status_str(__FILE__, __LINE__, passes, "drops nothing", actual, "0");
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    {
+        printf("## remote player\n");
+
+        char log[] = "/tmp/ccodoc_stub_player_XXXXXX";
+        {
+            const int fd = mkstemp(log);
+            if (fd < 0) {
+                report_status(__FILE__, __LINE__, false, "log", "failed to create", "created");
+                return EXIT_FAILURE;
+            }
+            (void)close(fd);
+        }
+
+        const char* const args[] = { "sh", "tool/test/stub_player.sh", log, NULL };
+
+        struct remote_player player = { 0 };
+        {
+            const char* const err = start_remote_player(&player, "/bin/sh", args);
+            if (err != NULL) {
+                report_status(__FILE__, __LINE__, false, "start", err, "no error");
+                free((void*)err);
+                (void)unlink(log);
+                return EXIT_FAILURE;
+            }
+        }
+
+        static const struct test {
+            const char* label;
+            const char* file;
+            bool kills;
+            const char* expected;
+        } tests[] = {
+            { "loads", "tsutsu_drip.mp3", false, "LOAD tsutsu_drip.mp3\n" },
+            { "loads again", "tsutsu_bump.mp3", true, "LOAD tsutsu_drip.mp3\nLOAD tsutsu_bump.mp3\n" },
+            { "restarts the player killed", "uguisu_call.mp3", false, "LOAD tsutsu_drip.mp3\nLOAD tsutsu_bump.mp3\nLOAD uguisu_call.mp3\n" },
+        };
+        static const size_t tests_len = sizeof(tests) / sizeof(struct test);
+
+        int result = EXIT_SUCCESS;
+
+        for (size_t i = 0; i < tests_len && result == EXIT_SUCCESS; i++) {
+            const struct test test = tests[i];
+
+            const char* const err = load_remote_player(&player, test.file);
+            if (err != NULL) {
+                report_status(__FILE__, __LINE__, false, test.label, err, "no error");
+                free((void*)err);
+                result = EXIT_FAILURE;
+                break;
+            }
+
+            char actual[1 << 7] = { 0 };
+            const bool passes = wait_for_file(log, test.expected, actual, sizeof(actual));
+            report_status(__FILE__, __LINE__, passes, test.label, actual, test.expected);
+            if (!passes) {
+                result = EXIT_FAILURE;
+                break;
+            }
+
+            if (test.kills) {
+                // Kill the player as if it crashed.
+                const int pid = player.cmd.pid;
+                (void)kill(pid, SIGKILL);
+                (void)waitpid(pid, NULL, 0);
+            }
+        }
+
+        stop_remote_player(&player);
+        (void)unlink(log);
+
+        if (result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void record_sound(struct played_sounds* const played, const char* const file)
+{
+    if (played->len < sizeof(played->files) / sizeof(const char*)) {
+        played->files[played->len++] = file;
+    }
+}
+
+// wait_for_file waits a while for the file to have the expected content, which is read into the actual.
+static bool wait_for_file(const char* const path, const char* const expected, char* const actual, const size_t len)
+{
+    static const struct duration interval = { .nsecs = NSECS_FROM_MSECS(10) };
+    static const unsigned int tries = 200;
+
+    for (unsigned int i = 0; i < tries; i++) {
+        FILE* const file = fopen(path, "r");
+        if (file != NULL) {
+            const size_t n = fread(actual, sizeof(char), len - 1, file);
+            actual[n] = '\0';
+            (void)fclose(file);
+
+            if (str_equals(actual, expected)) {
+                return true;
+            }
+        }
+
+        sleep_for(interval);
+    }
+
+    return false;
+}
@@ -19,10 +19,18 @@ int main(void)
     EXPECT_PASS(test_platform());
     printf("\n");
 
+    printf("# sound\n");
+    EXPECT_PASS(test_sound());
+    printf("\n");
+
     printf("# renderer\n");
     EXPECT_PASS(test_renderer());
     printf("\n");
 
+    printf("# mode\n");
+    EXPECT_PASS(test_mode());
+    printf("\n");
+
     printf("ALL PASS\n");
 
     return EXIT_SUCCESS;
@@ -30,3 +30,5 @@ extern int test_str(void);
 extern int test_time(void);
 extern int test_platform(void);
 extern int test_renderer(void);
+extern int test_sound(void);
+extern int test_mode(void);
@@ -1,10 +1,13 @@
 #include "time.h"
 
 #include "math.h"
-#include <assert.h>
+#include <errno.h>
+#include <limits.h>
 #include <math.h>
 #include <time.h>
 
+static const uint64_t nsecs_per_sec = NSECS_FROM_MSECS(time_sec);
+
 static void ticker_tick(struct ticker* ticker, struct duration delta);
 static void ticker_reset(struct ticker* ticker);
 
@@ -23,10 +26,14 @@ bool timer_expires(const struct timer* const timer)
     return get_elapsed_time_ratio(timer) >= 1;
 }
 
+// get_elapsed_time_ratio returns the ratio of the time elapsed to the duration, where a timer of no duration has always expired.
 float get_elapsed_time_ratio(const struct timer* const timer)
 {
-    assert(timer->duration.msecs != 0);
-    return CLAMP(0, 1, (float)((double)timer->ticker.elapsed.msecs / (double)timer->duration.msecs));
+    if (timer->duration.nsecs == 0) {
+        return 1;
+    }
+
+    return CLAMP(0, 1, (float)((double)timer->ticker.elapsed.nsecs / (double)timer->duration.nsecs));
 }
 
 struct duration get_remaining_time(const struct timer* const timer)
@@ -39,15 +46,18 @@ struct duration get_overflow_time(const struct timer* const timer)
     return duration_diff(timer->ticker.elapsed, timer->duration);
 }
 
-void sleep_for(const struct duration duration)
+// get_time_until_ratio returns the time left until the elapsed time ratio of the timer reaches the ratio.
+struct duration get_time_until_ratio(const struct timer* const timer, const double ratio)
 {
-    if (duration.msecs < 0) {
-        return;
-    }
+    const struct duration time = { .nsecs = (uint64_t)ceil(ratio * (double)timer->duration.nsecs) };
+    return duration_diff(time, timer->ticker.elapsed);
+}
 
+void sleep_for(const struct duration duration)
+{
     struct timespec time_spec = { 0 };
-    time_spec.tv_sec = (time_t)duration.msecs / 1000;
-    time_spec.tv_nsec = (time_t)duration.msecs % 1000 * 1000000;
+    time_spec.tv_sec = (time_t)(duration.nsecs / nsecs_per_sec);
+    time_spec.tv_nsec = (long)(duration.nsecs % nsecs_per_sec);
 
     int slept = -1;
     do {
@@ -55,23 +65,165 @@ void sleep_for(const struct duration duration)
     } while (slept != 0);
 }
 
+// sleep_until sleeps until the monotonic time reaches the time, which does not drift however long the sleep is interrupted.
+void sleep_until(const struct duration time)
+{
+#if PLATFORM == PLATFORM_LINUX
+    const struct timespec time_spec = {
+        .tv_sec = (time_t)(time.nsecs / nsecs_per_sec),
+        .tv_nsec = (long)(time.nsecs % nsecs_per_sec),
+    };
+
+    // clock_nanosleep returns the error instead of setting errno, and only EINTR is worth sleeping again for.
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time_spec, NULL) == EINTR) { }
+#else
+    sleep_for(duration_diff(time, get_monotonic_time()));
+#endif
+}
+
+struct clock wrap_clock_monotonic(void)
+{
+    return (struct clock) {
+        .type = clock_monotonic,
+    };
+}
+
+struct clock wrap_clock_virtual(struct clock_virtual* const clock)
+{
+    return (struct clock) {
+        .type = clock_virtual,
+        .delegate = { .virtual = clock },
+    };
+}
+
+struct duration get_clock_time(const struct clock* const clock)
+{
+    switch (clock->type) {
+    case clock_monotonic:
+        return get_monotonic_time();
+    case clock_virtual:
+        return clock->delegate.virtual->time;
+    }
+}
+
+// sleep_clock_until sleeps until the clock reaches the time, which the virtual clock does at once by moving on to the time.
+void sleep_clock_until(const struct clock* const clock, const struct duration time)
+{
+    switch (clock->type) {
+    case clock_monotonic:
+        sleep_until(time);
+        break;
+    case clock_virtual: {
+        struct clock_virtual* const virtual = clock->delegate.virtual;
+        if (time.nsecs <= virtual->time.nsecs) {
+            break;
+        }
+
+        const uint64_t oversleep = virtual->jitter.nsecs != 0
+            ? (uint64_t)virtual->sleeps * 7919 % (virtual->jitter.nsecs + 1)
+            : 0;
+        virtual->sleeps++;
+
+        virtual->time.nsecs = time.nsecs + oversleep;
+        break;
+    }
+    }
+}
+
+void schedule_frame(struct frame_pacing* const pacing, const struct duration deadline)
+{
+    pacing->deadline = deadline;
+}
+
+// wake_up_frame records how late the frame is woken up at the time for its deadline.
+void wake_up_frame(struct frame_pacing* const pacing, const struct duration time, const struct duration frame_time)
+{
+    pacing->frames++;
+
+    if (time.nsecs < pacing->deadline.nsecs) {
+        // Woken up early for something else than the deadline.
+        return;
+    }
+
+    pacing->jitter = duration_diff(time, pacing->deadline);
+    pacing->max_jitter.nsecs = MAX(pacing->max_jitter.nsecs, pacing->jitter.nsecs);
+
+    if (pacing->jitter.nsecs >= frame_time.nsecs) {
+        pacing->overruns++;
+    }
+}
+
+void init_frame_rate(struct frame_rate* const rate, const unsigned int max, const bool adaptive)
+{
+    *rate = (struct frame_rate) {
+        .max = MAX(max, 1),
+        .adaptive = adaptive,
+    };
+    rate->current = rate->max;
+}
+
+struct duration get_frame_time(const struct frame_rate* const rate)
+{
+    return (struct duration) { .nsecs = nsecs_per_sec / rate->current };
+}
+
+// adapt_frame_rate takes the time presenting a frame took into the average,
+// and moves the adaptive rate so that presenting takes between an eighth and a half of the frame time.
+// The rate goes down at once to where presenting would take a quarter of the frame time,
+// while it goes back up by a quarter at a time so that a few cheap frames do not swing it.
+void adapt_frame_rate(struct frame_rate* const rate, const struct duration cost)
+{
+    if (!rate->adaptive) {
+        return;
+    }
+
+    // Average the costs over the last several frames or so.
+    rate->cost.nsecs = rate->cost.nsecs == 0
+        ? cost.nsecs
+        : rate->cost.nsecs - rate->cost.nsecs / 8 + cost.nsecs / 8;
+
+    const uint64_t frame_time = get_frame_time(rate).nsecs;
+
+    if (rate->cost.nsecs > frame_time / 2) {
+        const uint64_t fps = nsecs_per_sec / (rate->cost.nsecs * 4);
+        rate->current = (unsigned int)CLAMP(1, rate->current, fps);
+        return;
+    }
+
+    if (rate->cost.nsecs < frame_time / 8) {
+        rate->current = MIN(rate->max, rate->current + (rate->current + 3) / 4);
+    }
+}
+
+// fps_from_duration returns the lowest frame rate whose frame time is no longer than the duration.
+unsigned int fps_from_duration(const struct duration duration)
+{
+    if (duration.nsecs == 0) {
+        return UINT_MAX;
+    }
+
+    const uint64_t fps = (nsecs_per_sec + duration.nsecs - 1) / duration.nsecs;
+
+    return (unsigned int)MIN(fps, UINT_MAX);
+}
+
 struct moment moment_from_duration(const struct duration duration, const enum time_precision precision)
 {
     struct moment moment = { 0 };
     struct duration current = duration;
 
     if (precision <= time_hour) {
-        double hours = (double)current.msecs / time_hour;
+        double hours = (double)current.nsecs / (double)NSECS_FROM_MSECS(time_hour);
         if (precision == time_hour) {
             hours = ceil(hours);
         }
         moment.hours = (unsigned int)hours;
 
-        current.msecs -= (unsigned long)moment.hours * time_hour;
+        current = duration_diff(current, duration_from_msecs((uint64_t)moment.hours * time_hour));
     }
 
     if (precision <= time_min) {
-        double mins = (double)current.msecs / time_min;
+        double mins = (double)current.nsecs / (double)NSECS_FROM_MSECS(time_min);
         if (precision == time_min) {
             mins = ceil(mins);
         }
@@ -79,11 +231,11 @@ struct moment moment_from_duration(const struct duration duration, const enum ti
 
         moment.mins = (unsigned int)mins;
 
-        current.msecs -= (unsigned long)moment.mins * time_min;
+        current = duration_diff(current, duration_from_msecs((uint64_t)moment.mins * time_min));
     }
 
     if (precision <= time_sec) {
-        double secs = (double)current.msecs / time_sec;
+        double secs = (double)current.nsecs / (double)NSECS_FROM_MSECS(time_sec);
         if (precision == time_sec) {
             secs = ceil(secs);
         }
@@ -91,11 +243,11 @@ struct moment moment_from_duration(const struct duration duration, const enum ti
 
         moment.secs = (unsigned int)secs;
 
-        current.msecs -= (unsigned long)moment.secs * time_sec;
+        current = duration_diff(current, duration_from_msecs((uint64_t)moment.secs * time_sec));
     }
 
     if (precision <= time_msec) {
-        double msecs = (double)current.msecs / time_msec;
+        double msecs = (double)current.nsecs / (double)NSECS_FROM_MSECS(time_msec);
         if (precision == time_msec) {
             msecs = ceil(msecs);
         }
@@ -103,7 +255,7 @@ struct moment moment_from_duration(const struct duration duration, const enum ti
 
         moment.msecs = (unsigned int)msecs;
 
-        current.msecs -= (unsigned long)moment.msecs * time_msec;
+        current = duration_diff(current, duration_from_msecs((uint64_t)moment.msecs * time_msec));
     }
 
     return moment;
@@ -111,36 +263,67 @@ struct moment moment_from_duration(const struct duration duration, const enum ti
 
 struct duration duration_from_moment(const struct moment moment)
 {
-    return (struct duration) {
-        .msecs = moment.hours * time_hour + moment.mins * time_min + moment.secs * time_sec + moment.msecs * time_msec,
-    };
+    return duration_from_msecs(
+        (uint64_t)moment.hours * time_hour
+        + (uint64_t)moment.mins * time_min
+        + (uint64_t)moment.secs * time_sec
+        + (uint64_t)moment.msecs * time_msec
+    );
+}
+
+struct duration duration_from_msecs(const uint64_t msecs)
+{
+    return (struct duration) { .nsecs = NSECS_FROM_MSECS(msecs) };
+}
+
+// msecs_from_duration returns the whole msecs in the duration, truncating the rest.
+uint64_t msecs_from_duration(const struct duration duration)
+{
+    return duration.nsecs / NSECS_FROM_MSECS(1);
 }
 
 struct duration duration_diff(const struct duration duration, const struct duration other)
 {
     return (struct duration) {
-        .msecs = duration.msecs > other.msecs ? duration.msecs - other.msecs : 0,
+        .nsecs = duration.nsecs > other.nsecs ? duration.nsecs - other.nsecs : 0,
     };
 }
 
+// scale_duration scales the duration by the factor, saturating at the longest duration rather than overflowing.
+struct duration scale_duration(const struct duration duration, const double factor)
+{
+    if (factor == 1) {
+        return duration;
+    }
+
+    const double nsecs = round((double)duration.nsecs * factor);
+    // The negation also takes NaN, such as 0 scaled by an infinite factor.
+    if (!(nsecs > 0)) {
+        return (struct duration) { 0 };
+    }
+    // UINT64_MAX is not representable as a double, which rounds it up to 2^64.
+    if (nsecs >= (double)UINT64_MAX) {
+        return (struct duration) { .nsecs = UINT64_MAX };
+    }
+
+    return (struct duration) { .nsecs = (uint64_t)nsecs };
+}
+
+// get_monotonic_time returns the monotonic time as it is in nsecs, so that the deltas between the times add up to the wall time.
 struct duration get_monotonic_time(void)
 {
     struct timespec time = { 0 };
     clock_gettime(CLOCK_MONOTONIC, &time);
 
-    unsigned long msecs = 0;
-    msecs += time.tv_sec * time_sec;
-    msecs += (long)round((double)time.tv_nsec / 1.0e6);
-
-    return (struct duration) { .msecs = msecs };
+    return (struct duration) { .nsecs = (uint64_t)time.tv_sec * nsecs_per_sec + (uint64_t)time.tv_nsec };
 }
 
 static void ticker_tick(struct ticker* const ticker, const struct duration delta)
 {
-    ticker->elapsed.msecs += delta.msecs;
+    ticker->elapsed.nsecs += delta.nsecs;
 }
 
 static void ticker_reset(struct ticker* const ticker)
 {
-    ticker->elapsed.msecs = 0;
+    ticker->elapsed.nsecs = 0;
 }
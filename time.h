@@ -1,8 +1,12 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h> // IWYU pragma: export
 
+// NSECS_FROM_MSECS converts the msecs into nsecs, which constant initializers of durations can use.
+#define NSECS_FROM_MSECS(msecs) ((uint64_t)(msecs) * 1000000)
+
 enum time_precision {
     time_msec = 1,
     time_sec = 1000 * time_msec,
@@ -17,8 +21,9 @@ struct moment {
     unsigned int msecs;
 };
 
+// duration keeps nsecs in 64 bits, which neither rounds frame deltas nor overflows for centuries.
 struct duration {
-    unsigned long msecs;
+    uint64_t nsecs;
 };
 
 struct ticker {
@@ -30,6 +35,55 @@ struct timer {
     struct ticker ticker;
 };
 
+// frame_pacing keeps the absolute deadline of the next frame and how late frames are woken up for their deadlines.
+struct frame_pacing {
+    struct duration deadline;
+
+    struct duration jitter;
+    struct duration max_jitter;
+    // frames counts the frames woken up, early or not.
+    unsigned long frames;
+    // overruns counts the frames woken up a whole frame time or more late.
+    unsigned long overruns;
+};
+
+// frame_rate caps how often frames are drawn.
+// The adaptive one goes down under the cap while presenting frames takes a large share of the frame time,
+// for example over a slow connection, and back up once there is headroom again.
+struct frame_rate {
+    unsigned int max;
+    bool adaptive;
+
+    unsigned int current;
+    // cost is the moving average of the time presenting a frame takes.
+    struct duration cost;
+};
+
+enum clock_type {
+    clock_monotonic,
+    clock_virtual,
+};
+
+// clock_virtual is a clock whose time goes on only by sleeping, which runs hours in no time.
+struct clock_virtual {
+    struct duration time;
+
+    // jitter is the most the clock oversleeps by, which varies from sleep to sleep as the monotonic clock does
+    // but in the same way on every run.
+    struct duration jitter;
+    unsigned long sleeps;
+};
+
+union clock_delegate {
+    struct clock_virtual* virtual;
+};
+
+// clock tells the time and sleeps until a time, in the monotonic time or in a virtual one.
+struct clock {
+    enum clock_type type;
+    union clock_delegate delegate;
+};
+
 // - timer
 extern void tick_timer(struct timer* timer, const struct duration delta);
 extern void reset_timer(struct timer* timer);
@@ -37,14 +91,35 @@ extern bool timer_expires(const struct timer* timer);
 extern float get_elapsed_time_ratio(const struct timer* timer);
 extern struct duration get_remaining_time(const struct timer* timer);
 extern struct duration get_overflow_time(const struct timer* timer);
+extern struct duration get_time_until_ratio(const struct timer* timer, double ratio);
 
 // - sleep
 extern void sleep_for(const struct duration duration);
+extern void sleep_until(const struct duration time);
+
+// - clock
+extern struct clock wrap_clock_monotonic(void);
+extern struct clock wrap_clock_virtual(struct clock_virtual* clock);
+extern struct duration get_clock_time(const struct clock* clock);
+extern void sleep_clock_until(const struct clock* clock, struct duration time);
+
+// - frame pacing
+extern void schedule_frame(struct frame_pacing* pacing, struct duration deadline);
+extern void wake_up_frame(struct frame_pacing* pacing, struct duration time, struct duration frame_time);
+
+// - frame rate
+extern void init_frame_rate(struct frame_rate* rate, unsigned int max, bool adaptive);
+extern struct duration get_frame_time(const struct frame_rate* rate);
+extern void adapt_frame_rate(struct frame_rate* rate, struct duration cost);
+extern unsigned int fps_from_duration(struct duration duration);
 
 // - moment
 extern struct moment moment_from_duration(const struct duration duration, enum time_precision precision);
 
 // - duration
 extern struct duration duration_from_moment(const struct moment moment);
+extern struct duration duration_from_msecs(uint64_t msecs);
+extern uint64_t msecs_from_duration(const struct duration duration);
 extern struct duration duration_diff(const struct duration duration, const struct duration other);
+extern struct duration scale_duration(const struct duration duration, double factor);
 extern struct duration get_monotonic_time(void);
@@ -1,6 +1,9 @@
 #include "time.h"
 
+#include "math.h"
 #include "test.h"
+#include <inttypes.h>
+#include <math.h>
 #include <stdio.h>
 
 struct timer_state {
@@ -20,7 +23,7 @@ int test_time(void)
         printf("## timer (duration: 00:00:01:00)\n");
 
         struct timer timer = {
-            .duration = { .msecs = 1000 },
+            .duration = { .nsecs = NSECS_FROM_MSECS(1000) },
         };
 
         static const struct test {
@@ -30,34 +33,34 @@ int test_time(void)
         } tests[] = {
             (struct test) {
                 .label = "initial",
-                .delta = (struct duration) { .msecs = 0 },
+                .delta = (struct duration) { .nsecs = NSECS_FROM_MSECS(0) },
                 .expected = (struct timer_state) {
                     .get_elapsed_time_ratio = 0,
-                    .get_remaining_time = { .msecs = 1000 },
+                    .get_remaining_time = { .nsecs = NSECS_FROM_MSECS(1000) },
                 },
             },
             (struct test) {
                 .label = "tick 200 msecs",
-                .delta = (struct duration) { .msecs = 200 },
+                .delta = (struct duration) { .nsecs = NSECS_FROM_MSECS(200) },
                 .expected = (struct timer_state) {
                     .get_elapsed_time_ratio = 0.2f,
-                    .get_remaining_time = { .msecs = 800 },
+                    .get_remaining_time = { .nsecs = NSECS_FROM_MSECS(800) },
                 },
             },
             (struct test) {
                 .label = "tick 400 msecs",
-                .delta = (struct duration) { .msecs = 400 },
+                .delta = (struct duration) { .nsecs = NSECS_FROM_MSECS(400) },
                 .expected = (struct timer_state) {
                     .get_elapsed_time_ratio = 0.6f,
-                    .get_remaining_time = { .msecs = 400 },
+                    .get_remaining_time = { .nsecs = NSECS_FROM_MSECS(400) },
                 },
             },
             (struct test) {
                 .label = "tick 600 msecs",
-                .delta = (struct duration) { .msecs = 600 },
+                .delta = (struct duration) { .nsecs = NSECS_FROM_MSECS(600) },
                 .expected = (struct timer_state) {
                     .get_elapsed_time_ratio = 1,
-                    .get_remaining_time = { .msecs = 0 },
+                    .get_remaining_time = { .nsecs = NSECS_FROM_MSECS(0) },
                 },
             },
         };
@@ -75,7 +78,7 @@ int test_time(void)
             &timer,
             ((struct timer_state) {
                 .get_elapsed_time_ratio = 0,
-                .get_remaining_time = { .msecs = 1000 },
+                .get_remaining_time = { .nsecs = NSECS_FROM_MSECS(1000) },
             })
         );
     }
@@ -128,6 +131,166 @@ int test_time(void)
         }
     }
 
+    {
+        printf("## frame rate (max: 25, adaptive)\n");
+
+        struct frame_rate rate = { 0 };
+        init_frame_rate(&rate, 25, true);
+
+        static const struct test {
+            const char* label;
+            struct duration cost;
+            unsigned int frames;
+            unsigned int expected;
+        } tests[] = {
+            // Presenting takes three quarters of the frame time, as over a slow connection.
+            { "lowers to where presenting takes a quarter", { .nsecs = NSECS_FROM_MSECS(30) }, 10, 8 },
+            { "raises back up to the max", { .nsecs = NSECS_FROM_MSECS(1) }, 100, 25 },
+            { "stays at the max", { .nsecs = NSECS_FROM_MSECS(1) }, 100, 25 },
+            { "lowers to 1 at least", { .nsecs = NSECS_FROM_MSECS(2000) }, 10, 1 },
+            { "raises back up from 1", { 0 }, 100, 25 },
+        };
+        static const size_t tests_len = sizeof(tests) / sizeof(struct test);
+
+        for (size_t i = 0; i < tests_len; i++) {
+            const struct test test = tests[i];
+
+            for (unsigned int j = 0; j < test.frames; j++) {
+                adapt_frame_rate(&rate, test.cost);
+            }
+
+            char actual[1 << 5] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%u fps", rate.current);
+
+            char expected[1 << 5] = { 0 };
+            (void)snprintf(expected, sizeof(expected), "%u fps", test.expected);
+
+            const bool passes = rate.current == test.expected
+                && get_frame_time(&rate).nsecs == NSECS_FROM_MSECS(time_sec) / test.expected;
+            report_status(__FILE__, __LINE__, passes, test.label, actual, expected);
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    {
+        printf("## frame rate (max: 25)\n");
+
+        struct frame_rate rate = { 0 };
+        init_frame_rate(&rate, 25, false);
+
+        for (unsigned int i = 0; i < 10; i++) {
+            adapt_frame_rate(&rate, (struct duration) { .nsecs = NSECS_FROM_MSECS(2000) });
+        }
+
+        char actual[1 << 5] = { 0 };
+        (void)snprintf(actual, sizeof(actual), "%u fps", rate.current);
+
+        const bool passes = rate.current == 25;
+        report_status(__FILE__, __LINE__, passes, "stays at the max however slow presenting is", actual, "25 fps");
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    {
+        printf("## scale duration\n");
+
+        static const struct test {
+            const char* label;
+            struct duration duration;
+            double factor;
+            uint64_t expected;
+        } tests[] = {
+            { "scales", { .nsecs = NSECS_FROM_MSECS(40) }, 100, NSECS_FROM_MSECS(4000) },
+            { "rounds", { .nsecs = 3 }, 0.5, 2 },
+            { "saturates", { .nsecs = NSECS_FROM_MSECS(40) }, 1e12, UINT64_MAX },
+            { "takes 0 times an infinite factor as 0", { 0 }, INFINITY, 0 },
+        };
+        static const size_t tests_len = sizeof(tests) / sizeof(struct test);
+
+        for (size_t i = 0; i < tests_len; i++) {
+            const struct test test = tests[i];
+
+            const uint64_t nsecs = scale_duration(test.duration, test.factor).nsecs;
+
+            char actual[1 << 5] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%" PRIu64 " nsecs", nsecs);
+
+            char expected[1 << 5] = { 0 };
+            (void)snprintf(expected, sizeof(expected), "%" PRIu64 " nsecs", test.expected);
+
+            const bool passes = nsecs == test.expected;
+            report_status(__FILE__, __LINE__, passes, test.label, actual, expected);
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    {
+        printf("## msecs\n");
+
+        static const struct test {
+            const char* label;
+            uint64_t nsecs;
+            uint64_t expected;
+        } tests[] = {
+            { "0", 0, 0 },
+            { "truncates the sub-msec part", NSECS_FROM_MSECS(1234) + NSECS_FROM_MSECS(1) - 1, 1234 },
+            { "8 hours", NSECS_FROM_MSECS((uint64_t)8 * time_hour) + 1, (uint64_t)8 * time_hour },
+        };
+        static const size_t tests_len = sizeof(tests) / sizeof(struct test);
+
+        for (size_t i = 0; i < tests_len; i++) {
+            const struct test test = tests[i];
+
+            const uint64_t msecs = msecs_from_duration((struct duration) { .nsecs = test.nsecs });
+            const uint64_t nsecs = duration_from_msecs(test.expected).nsecs;
+
+            char actual[1 << 6] = { 0 };
+            (void)snprintf(actual, sizeof(actual), "%" PRIu64 " msecs, back to %" PRIu64 " nsecs", msecs, nsecs);
+
+            char expected[1 << 6] = { 0 };
+            (void)snprintf(expected, sizeof(expected), "%" PRIu64 " msecs, back to %" PRIu64 " nsecs", test.expected, test.expected * 1000000);
+
+            const bool passes = msecs == test.expected && nsecs == test.expected * 1000000;
+            report_status(__FILE__, __LINE__, passes, test.label, actual, expected);
+            if (!passes) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    {
+        printf("## monotonic time\n");
+
+        // The time is the monotonic clock as it is in nsecs, which falls between the readings around it.
+        struct timespec before = { 0 };
+        clock_gettime(CLOCK_MONOTONIC, &before);
+
+        const struct duration time = get_monotonic_time();
+
+        struct timespec after = { 0 };
+        clock_gettime(CLOCK_MONOTONIC, &after);
+
+        const uint64_t min = (uint64_t)before.tv_sec * 1000000000 + (uint64_t)before.tv_nsec;
+        const uint64_t max = (uint64_t)after.tv_sec * 1000000000 + (uint64_t)after.tv_nsec;
+
+        char actual[1 << 6] = { 0 };
+        (void)snprintf(actual, sizeof(actual), "%" PRIu64 " nsecs", time.nsecs);
+
+        char expected[1 << 6] = { 0 };
+        (void)snprintf(expected, sizeof(expected), "%" PRIu64 "-%" PRIu64 " nsecs", min, max);
+
+        const bool passes = time.nsecs >= min && time.nsecs <= max;
+        report_status(__FILE__, __LINE__, passes, "in nsecs", actual, expected);
+        if (!passes) {
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -145,19 +308,19 @@ static int expect_timer(
     char actual_label[1 << 8] = { 0 };
     (void)snprintf(
         actual_label, sizeof(actual_label),
-        "get_elapsed_time_ratio: %f, get_remaining_time: %ld msecs",
-        actual.get_elapsed_time_ratio, actual.get_remaining_time.msecs
+        "get_elapsed_time_ratio: %f, get_remaining_time: %" PRIu64 " nsecs",
+        actual.get_elapsed_time_ratio, actual.get_remaining_time.nsecs
     );
 
     char expected_label[1 << 8] = { 0 };
     (void)snprintf(
         expected_label, sizeof(expected_label),
-        "get_elapsed_time_ratio: %f, get_remaining_time: %ld msecs",
-        expected.get_elapsed_time_ratio, expected.get_remaining_time.msecs
+        "get_elapsed_time_ratio: %f, get_remaining_time: %" PRIu64 " nsecs",
+        expected.get_elapsed_time_ratio, expected.get_remaining_time.nsecs
     );
 
     const bool passes = actual.get_elapsed_time_ratio == expected.get_elapsed_time_ratio
-        && actual.get_remaining_time.msecs == expected.get_remaining_time.msecs;
+        && actual.get_remaining_time.nsecs == expected.get_remaining_time.nsecs;
 
     report_status(file, line, passes, label, actual_label, expected_label);
 
@@ -186,8 +349,8 @@ static int expect_moment_from_duration(
 {
     const struct moment actual = moment_from_duration(duration, precision);
 
-    char label[1 << 5] = { 0 };
-    (void)snprintf(label, sizeof(label), "%ld msecs in %s", duration.msecs, time_precision_to_str(precision));
+    char label[1 << 6] = { 0 };
+    (void)snprintf(label, sizeof(label), "%" PRIu64 " nsecs in %s", duration.nsecs, time_precision_to_str(precision));
 
     char actual_label[1 << 8] = { 0 };
     (void)snprintf(
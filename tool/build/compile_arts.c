@@ -0,0 +1,237 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { art_max_height = 8 };
+
+// glyph_attr assigns the drawing attribute to a glyph in an art.
+struct glyph_attr {
+    const char* glyph;
+    const char* attr;
+};
+
+struct art {
+    const char* name;
+    const char* rows[art_max_height];
+
+    const char* attr;
+    const struct glyph_attr* glyph_attrs;
+};
+
+static const struct glyph_attr kakehi_glyph_attrs[] = {
+    { .glyph = u8"━", .attr = "{ .color = color_blue }" },
+    { 0 },
+};
+
+static const struct glyph_attr tsutsu_glyph_attrs[] = {
+    { .glyph = u8"◥", .attr = "{ .color = color_green }" },
+    { .glyph = u8"◣", .attr = "{ .color = color_green }" },
+    { .glyph = u8"◢", .attr = "{ .color = color_green }" },
+    { .glyph = u8"◤", .attr = "{ .color = color_green }" },
+    { .glyph = u8"▕", .attr = "{ .color = color_yellow }" },
+    { 0 },
+};
+
+static const struct glyph_attr hachi_glyph_attrs[] = {
+    { .glyph = u8"▬", .attr = "{ .color = color_blue }" },
+    { 0 },
+};
+
+static const struct glyph_attr roji_glyph_attrs[] = {
+    { .glyph = u8"━", .attr = "{ .color = color_green, .dim = true }" },
+    { .glyph = u8"▨", .attr = "{ .color = color_grey }" },
+    { 0 },
+};
+
+static const struct art arts[] = {
+    // ki（起）
+    { .name = "art_kakehi_ki", .rows = { u8"━══" }, .attr = "{ .color = color_yellow }", .glyph_attrs = kakehi_glyph_attrs },
+    // sho（承）
+    { .name = "art_kakehi_sho", .rows = { u8"═━═" }, .attr = "{ .color = color_yellow }", .glyph_attrs = kakehi_glyph_attrs },
+    // ten（転）
+    { .name = "art_kakehi_ten", .rows = { u8"══━" }, .attr = "{ .color = color_yellow }", .glyph_attrs = kakehi_glyph_attrs },
+    // ketsu（結）
+    { .name = "art_kakehi_ketsu", .rows = { u8"═══" }, .attr = "{ .color = color_yellow }", .glyph_attrs = kakehi_glyph_attrs },
+
+    // jo (序)
+    {
+        .name = "art_tsutsu_jo",
+        .rows = {
+            u8"◥◣",
+            u8"  ◥◣",
+            u8"  ▕ ◥◣",
+            u8"  ▕   ◥◣",
+        },
+        .attr = "{ .color = color_white }",
+        .glyph_attrs = tsutsu_glyph_attrs,
+    },
+    // ha (破)
+    {
+        .name = "art_tsutsu_ha",
+        .rows = {
+            u8"",
+            u8"◢◤◢◤◢◤◢◤",
+            u8"  ▕ ",
+            u8"  ▕ ",
+        },
+        .attr = "{ .color = color_white }",
+        .glyph_attrs = tsutsu_glyph_attrs,
+    },
+    // kyu (急)
+    {
+        .name = "art_tsutsu_kyu",
+        .rows = {
+            u8"      ◢◤",
+            u8"    ◢◤",
+            u8"  ◢◤",
+            u8"◢◤▕",
+        },
+        .attr = "{ .color = color_white }",
+        .glyph_attrs = tsutsu_glyph_attrs,
+    },
+
+    { .name = "art_hachi_jo", .rows = { u8"▭▭▭▭" }, .attr = "{ .color = color_grey }", .glyph_attrs = hachi_glyph_attrs },
+    { .name = "art_hachi_ha", .rows = { u8"▭▬▬▭" }, .attr = "{ .color = color_grey }", .glyph_attrs = hachi_glyph_attrs },
+    { .name = "art_hachi_kyu", .rows = { u8"▬▭▭▬" }, .attr = "{ .color = color_grey }", .glyph_attrs = hachi_glyph_attrs },
+
+    { .name = "art_roji", .rows = { u8"━━━━━━▨▨▨▨" }, .attr = "{ 0 }", .glyph_attrs = roji_glyph_attrs },
+};
+static const size_t arts_len = sizeof(arts) / sizeof(struct art);
+
+static size_t decode_char_utf8(uint32_t* code, const char* src);
+static size_t count_chars_utf8(const char* src);
+static const char* find_glyph_attr(const struct art* art, const char* glyph, size_t len);
+
+#define COMPILE_ART(dst, art, ...)                                             \
+    {                                                                          \
+        const int n = fprintf((dst), __VA_ARGS__);                             \
+        if (n < 0) {                                                           \
+            (void)fprintf(stderr, "failed to compile art: %s\n", (art)->name); \
+            return EXIT_FAILURE;                                               \
+        }                                                                      \
+    }
+
+int main(void)
+{
+    FILE* const dst = fopen("./assets/arts/arts.h", "w");
+    if (dst == NULL) {
+        (void)fprintf(stderr, "failed to open destination file\n");
+        return EXIT_FAILURE;
+    }
+
+    {
+        const char data[] = "#pragma once\n";
+        const size_t len = sizeof(data) - 1;
+        const size_t n = fwrite(data, sizeof(char), len, dst);
+        if (n != len) {
+            (void)fprintf(stderr, "failed to compile arts\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (size_t i = 0; i < arts_len; i++) {
+        const struct art* const art = &arts[i];
+
+        size_t width = 0;
+        size_t height = 0;
+        for (size_t h = 0; h < art_max_height && art->rows[h] != NULL; h++) {
+            const size_t len = count_chars_utf8(art->rows[h]);
+            width = len > width ? len : width;
+            height++;
+        }
+
+        COMPILE_ART(dst, art, "\n");
+        COMPILE_ART(dst, art, "static const struct art_cell %s_cells[] = {\n", art->name);
+
+        for (size_t h = 0; h < height; h++) {
+            const char* c = art->rows[h];
+
+            COMPILE_ART(dst, art, "   ");
+
+            for (size_t w = 0; w < width; w++) {
+                // Pad short rows with transparent cells to keep the art rectangular.
+                if (!*c) {
+                    COMPILE_ART(dst, art, " { 0 },");
+                    continue;
+                }
+
+                uint32_t code = 0;
+                const size_t len = decode_char_utf8(&code, c);
+
+                COMPILE_ART(dst, art, " { 0x%04x, %s },", code, find_glyph_attr(art, c, len));
+
+                c += len;
+            }
+
+            COMPILE_ART(dst, art, "\n");
+        }
+
+        COMPILE_ART(dst, art, "};\n");
+        COMPILE_ART(
+            dst, art,
+            "static const struct art %s = { .size = { .x = %zu, .y = %zu }, .cells = %s_cells };\n",
+            art->name, width, height, art->name
+        );
+    }
+
+    {
+        int status = fclose(dst);
+        if (status != 0) {
+            (void)fprintf(stderr, "failed to close destination file\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    return 0;
+}
+
+static size_t decode_char_utf8(uint32_t* const code, const char* const src)
+{
+    const unsigned char* const c = (const unsigned char*)src;
+
+    size_t len = 1;
+    if (*c >= 0xf0) {
+        len = 4;
+        *code = 0x07 & *c;
+    } else if (*c >= 0xe0) {
+        len = 3;
+        *code = 0x0f & *c;
+    } else if (*c >= 0xc0) {
+        len = 2;
+        *code = 0x1f & *c;
+    } else {
+        *code = 0x7f & *c;
+    }
+
+    for (size_t i = 1; i < len; i++) {
+        *code = (*code << 6) | (0x3f & c[i]);
+    }
+
+    return len;
+}
+
+static size_t count_chars_utf8(const char* const src)
+{
+    size_t n = 0;
+    for (const char* c = src; *c;) {
+        uint32_t code = 0;
+        c += decode_char_utf8(&code, c);
+        n++;
+    }
+
+    return n;
+}
+
+static const char* find_glyph_attr(const struct art* const art, const char* const glyph, const size_t len)
+{
+    for (const struct glyph_attr* attr = art->glyph_attrs; attr->glyph != NULL; attr++) {
+        if (strlen(attr->glyph) == len && strncmp(attr->glyph, glyph, len) == 0) {
+            return attr->attr;
+        }
+    }
+
+    return art->attr;
+}
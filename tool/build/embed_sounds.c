@@ -1,9 +1,11 @@
 #define _POSIX_C_SOURCE 200809L
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 static const char* read_file(char** data, size_t* len, const char* file);
+static uint64_t hash_data(const char* data, size_t len);
 
 #define EMBED_ASSET(dst, file, s)                                         \
     {                                                                     \
@@ -78,6 +80,11 @@ int main(void)
         }
 
         EMBED_ASSET(dst, asset.file, "};\n");
+
+        // The hash names the installed copy of the asset, so that a copy of any other content is never taken for it.
+        EMBEDF_ASSET(dst, asset.file, "const char %s_hash[] = \"%016llx\";\n", asset.name, (unsigned long long)hash_data(data, len));
+
+        free(data);
     }
 
     {
@@ -91,6 +98,18 @@ int main(void)
     return 0;
 }
 
+// hash_data hashes the data with 64-bit FNV-1a.
+static uint64_t hash_data(const char* const data, const size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
 static const char* read_file(char** const data, size_t* const len, const char* const file)
 {
     FILE* const src = fopen(file, "r");
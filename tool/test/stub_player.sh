@@ -0,0 +1,12 @@
+#!/bin/sh
+
+# stub_player.sh stands in for a player in its remote control mode, such as `mpg123 -R`,
+# appending the commands it receives to the log file.
+
+set -eu
+
+log="$1"
+
+while read -r cmd; do
+    printf '%s\n' "${cmd}" >>"${log}"
+done